@@ -181,14 +181,20 @@ void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer, struct attr *attr,
 	adj->attr = bgp_attr_intern(attr);
 	adj->uptime = monotime(NULL);
 	adj->addpath_rx_id = addpath_id;
-	BGP_ADJ_IN_ADD(dest, adj);
+	adj->next = dest->adj_in;
+	dest->adj_in = adj;
 	bgp_dest_lock_node(dest);
 }
 
 void bgp_adj_in_remove(struct bgp_dest **dest, struct bgp_adj_in *bai)
 {
+	struct bgp_adj_in **prev;
+
+	for (prev = &(*dest)->adj_in; *prev != bai; prev = &(*prev)->next)
+		assert(*prev);
+	*prev = bai->next;
+
 	bgp_attr_unintern(&bai->attr);
-	BGP_ADJ_IN_DEL(*dest, bai);
 	*dest = bgp_dest_unlock_node(*dest);
 	peer_unlock(bai->peer); /* adj_in peer reference */
 	XFREE(MTYPE_BGP_ADJ_IN, bai);
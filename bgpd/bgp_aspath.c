@@ -713,19 +713,21 @@ static void *aspath_hash_alloc(void *arg)
 	const struct aspath *aspath = arg;
 	struct aspath *new;
 
-	/* Malformed AS path value. */
-	assert(aspath->str);
-
 	/* New aspath structure is needed. */
 	new = XMALLOC(MTYPE_AS_PATH, sizeof(struct aspath));
 
-	/* Reuse segments and string representation */
+	/* Reuse segments, the string representation is built here as
+	 * aspath_parse() does not make it for lookups.
+	 */
 	new->refcnt = 0;
 	new->segments = aspath->segments;
-	new->str = aspath->str;
-	new->str_len = aspath->str_len;
-	new->json = aspath->json;
+	new->str = NULL;
+	new->str_len = 0;
+	new->json = NULL;
 	new->asnotation = aspath->asnotation;
+	memset(new->filter_cache, 0, sizeof(new->filter_cache));
+
+	aspath_str_update(new, false);
 
 	return new;
 }
@@ -857,15 +859,8 @@ struct aspath *aspath_parse(struct stream *s, size_t length, int use32bit,
 	find = hash_get(ashash, &as, aspath_hash_alloc);
 
 	/* if the aspath was already hashed free temporary memory. */
-	if (find->refcnt) {
+	if (find->refcnt)
 		assegment_free_all(as.segments);
-		/* aspath_key_make() always updates the string */
-		XFREE(MTYPE_AS_STR, as.str);
-		if (as.json) {
-			json_object_free(as.json);
-			as.json = NULL;
-		}
-	}
 
 	find->refcnt++;
 
@@ -2191,15 +2186,22 @@ struct aspath *aspath_str2aspath(const char *str,
 }
 
 /* Make hash value by raw aspath data. */
+/* Hash the binary segments, consistent with aspath_cmp().  The string
+ * form is only needed once an AS path actually gets interned, so looking
+ * up an already known path must not pay for formatting it.
+ */
 unsigned int aspath_key_make(const void *p)
 {
 	const struct aspath *aspath = p;
-	unsigned int key = 0;
+	const struct assegment *seg;
+	unsigned int key;
 
-	if (!aspath->str)
-		aspath_str_update((struct aspath *)aspath, false);
+	key = jhash_1word(aspath->asnotation, 2334325);
 
-	key = jhash(aspath->str, aspath->str_len, 2334325);
+	for (seg = aspath->segments; seg; seg = seg->next) {
+		key = jhash_2words(seg->type, seg->length, key);
+		key = jhash2(seg->as, seg->length, key);
+	}
 
 	return key;
 }
@@ -2321,10 +2323,32 @@ void bgp_aggr_aspath_remove(void *arg)
 void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
 				  struct aspath *aspath)
 {
+	struct aspath *aggr_aspath = NULL;
+	struct aspath *new_aspath;
+
+	if ((aggregate == NULL) || (aspath == NULL))
+		return;
+
+	if (aggregate->aspath_hash)
+		aggr_aspath = bgp_aggr_aspath_lookup(aggregate, aspath);
+
 	bgp_compute_aggregate_aspath_hash(aggregate, aspath);
 
-	bgp_compute_aggregate_aspath_val(aggregate);
+	/* Another contributor already carries this as-path, so the
+	 * aggregate's as-path does not change.
+	 */
+	if (aggr_aspath)
+		return;
 
+	/* Fold the new as-path into the aggregate's rather than
+	 * re-aggregating every as-path in the hash.
+	 */
+	if (aggregate->aspath) {
+		new_aspath = aspath_aggregate(aggregate->aspath, aspath);
+		aspath_free(aggregate->aspath);
+		aggregate->aspath = new_aspath;
+	} else
+		aggregate->aspath = aspath_dup(aspath);
 }
 
 void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
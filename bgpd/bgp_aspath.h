@@ -44,6 +44,18 @@ struct assegment {
 };
 
 /* AS path may be include some AsSegments.  */
+/* Verdict of an as-path access-list on an interned AS path, kept by
+ * as_list_apply().  Only valid while 'gen' matches the access-list
+ * generation.
+ */
+struct aspath_filter_cache {
+	const void *aslist;
+	uint32_t gen;
+	int type;
+};
+
+#define ASPATH_FILTER_CACHE_SLOTS 2
+
 struct aspath {
 	/* Reference count to this aspath.  */
 	unsigned long refcnt;
@@ -61,6 +73,9 @@ struct aspath {
 
 	/* AS notation used by string expression of AS path */
 	enum asnotation_mode asnotation;
+
+	/* Most recently used as-path access-list verdicts first */
+	struct aspath_filter_cache filter_cache[ASPATH_FILTER_CACHE_SLOTS];
 };
 
 #define ASPATH_STR_DEFAULT_LEN 32
@@ -877,6 +877,46 @@ bool attrhash_cmp(const void *p1, const void *p2)
 	return false;
 }
 
+/*
+ * Like attrhash_cmp(), but the AS path and the (extended, large)
+ * communities of 'attr' need not be interned: they are compared by value
+ * against those of the interned 'iattr'.  Outbound policy hands out fresh
+ * copies of these, so comparing them by pointer would never match.
+ */
+bool bgp_attr_same(const struct attr *iattr, const struct attr *attr)
+{
+	struct attr tmp = *attr;
+	struct community *comm, *icomm;
+	struct ecommunity *ecomm, *iecomm;
+	struct lcommunity *lcomm, *ilcomm;
+
+	if (tmp.aspath && iattr->aspath && tmp.aspath != iattr->aspath &&
+	    aspath_cmp(tmp.aspath, iattr->aspath))
+		tmp.aspath = iattr->aspath;
+
+	comm = bgp_attr_get_community(&tmp);
+	icomm = bgp_attr_get_community(iattr);
+	if (comm && icomm && comm != icomm && community_cmp(comm, icomm))
+		bgp_attr_set_community(&tmp, icomm);
+
+	ecomm = bgp_attr_get_ecommunity(&tmp);
+	iecomm = bgp_attr_get_ecommunity(iattr);
+	if (ecomm && iecomm && ecomm != iecomm && ecommunity_cmp(ecomm, iecomm))
+		bgp_attr_set_ecommunity(&tmp, iecomm);
+
+	ecomm = bgp_attr_get_ipv6_ecommunity(&tmp);
+	iecomm = bgp_attr_get_ipv6_ecommunity(iattr);
+	if (ecomm && iecomm && ecomm != iecomm && ecommunity_cmp(ecomm, iecomm))
+		bgp_attr_set_ipv6_ecommunity(&tmp, iecomm);
+
+	lcomm = bgp_attr_get_lcommunity(&tmp);
+	ilcomm = bgp_attr_get_lcommunity(iattr);
+	if (lcomm && ilcomm && lcomm != ilcomm && lcommunity_cmp(lcomm, ilcomm))
+		bgp_attr_set_lcommunity(&tmp, ilcomm);
+
+	return attrhash_cmp(iattr, &tmp);
+}
+
 static void attrhash_init(void)
 {
 	attrhash =
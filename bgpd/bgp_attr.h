@@ -395,6 +395,8 @@ extern bgp_size_t bgp_packet_attribute(
 extern void bgp_dump_routes_attr(struct stream *s, struct bgp_path_info *bpi,
 				 const struct prefix *p);
 extern bool attrhash_cmp(const void *arg1, const void *arg2);
+extern bool bgp_attr_same(const struct attr *iattr,
+			  const struct attr *attr);
 extern unsigned int attrhash_key_make(const void *p);
 extern void attr_show_all(struct vty *vty);
 extern unsigned long int attr_count(void);
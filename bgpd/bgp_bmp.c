@@ -1271,6 +1271,54 @@ static inline struct bmp_queue_entry *bmp_pull_locrib(struct bmp *bmp)
 				   &bmp->locrib_queuepos);
 }
 
+static size_t bmp_queue_size(struct bmp_targets *bt)
+{
+	return (bmp_qlist_count(&bt->updlist) +
+		bmp_qlist_count(&bt->locupdlist)) *
+	       sizeof(struct bmp_queue_entry);
+}
+
+/* The route monitoring queues are deduplicated per prefix & peer, but a
+ * session that cannot keep up still pins one entry per changed path.  When
+ * the configured limit is exceeded, the sessions holding the oldest entries
+ * are disconnected.  Dropping their backlog and re-walking the RIB would
+ * lose the withdrawals that were queued; closing the session makes the
+ * station discard its view, and it gets a full dump when it reconnects.
+ */
+static void bmp_queue_cull(struct bmp_targets *bt)
+{
+	size_t qsize = bmp_queue_size(bt);
+
+	bt->queue_sizemax = MAX(bt->queue_sizemax, qsize);
+
+	while (qsize > bt->queue_sizelimit) {
+		struct bmp_queue_entry *bqe, *lbqe;
+		struct bmp *bmp;
+		bool culled = false;
+
+		bqe = bmp_qlist_first(&bt->updlist);
+		lbqe = bmp_qlist_first(&bt->locupdlist);
+
+		frr_each_safe (bmp_session, &bt->sessions, bmp) {
+			if (!(bqe && bmp->queuepos == bqe) &&
+			    !(lbqe && bmp->locrib_queuepos == lbqe))
+				continue;
+
+			zlog_warn("bmp[%s] route monitoring queue over buffer limit, disconnecting",
+				  bmp->remote);
+			bt->cnt_queue_overruns++;
+			bmp_close(bmp);
+			bmp_free(bmp);
+			culled = true;
+		}
+
+		if (!culled)
+			break;
+
+		qsize = bmp_queue_size(bt);
+	}
+}
+
 /* TODO BMP_MON_LOCRIB find a way to merge properly this function with
  * bmp_wrqueue or abstract it if possible
  */
@@ -1565,6 +1613,8 @@ static int bmp_process(struct bgp *bgp, afi_t afi, safi_t safi,
 
 			pullwr_bump(bmp->pullwr);
 		}
+
+		bmp_queue_cull(bt);
 	}
 	return 0;
 }
@@ -1880,6 +1930,7 @@ static struct bmp_targets *bmp_targets_get(struct bgp *bgp, const char *name)
 	bmp_qlist_init(&bt->updlist);
 	bmp_qhash_init(&bt->locupdhash);
 	bmp_qlist_init(&bt->locupdlist);
+	bt->queue_sizelimit = ~0UL;
 	bmp_actives_init(&bt->actives);
 	bmp_listeners_init(&bt->listeners);
 
@@ -2455,6 +2506,38 @@ DEFPY(bmp_stats_cfg,
 	return CMD_SUCCESS;
 }
 
+DEFPY(bmp_monitor_limit_cfg,
+      bmp_monitor_limit_cmd,
+      "bmp monitor buffer-limit (0-4294967294)",
+      BMP_STR
+      "Send BMP route monitoring messages\n"
+      "Configure maximum memory used for queued route monitoring updates\n"
+      "Limit in bytes\n")
+{
+	VTY_DECLVAR_CONTEXT_SUB(bmp_targets, bt);
+
+	bt->queue_sizelimit = buffer_limit;
+	bmp_queue_cull(bt);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY(no_bmp_monitor_limit_cfg,
+      no_bmp_monitor_limit_cmd,
+      "no bmp monitor buffer-limit [(0-4294967294)]",
+      NO_STR
+      BMP_STR
+      "Send BMP route monitoring messages\n"
+      "Configure maximum memory used for queued route monitoring updates\n"
+      "Limit in bytes\n")
+{
+	VTY_DECLVAR_CONTEXT_SUB(bmp_targets, bt);
+
+	bt->queue_sizelimit = ~0UL;
+
+	return CMD_SUCCESS;
+}
+
 #define BMP_POLICY_IS_LOCRIB(str) ((str)[0] == 'l') /* __l__oc-rib */
 #define BMP_POLICY_IS_PRE(str) ((str)[1] == 'r')    /* p__r__e-policy */
 
@@ -2606,6 +2689,17 @@ DEFPY(show_bmp,
 			vty_out(vty, "  Targets \"%s\":\n", bt->name);
 			vty_out(vty, "    Route Mirroring %sabled\n",
 				bt->mirror ? "en" : "dis");
+			vty_out(vty, "    Route Monitoring %9zu bytes (%zu messages) pending\n",
+				bmp_queue_size(bt),
+				bmp_qlist_count(&bt->updlist) +
+					bmp_qlist_count(&bt->locupdlist));
+			vty_out(vty, "                     %9zu bytes maximum buffer used\n",
+				bt->queue_sizemax);
+			if (bt->queue_sizelimit != ~0UL)
+				vty_out(vty, "                     %9zu bytes buffer size limit\n",
+					bt->queue_sizelimit);
+			vty_out(vty, "                     %9" PRIu64 " sessions dropped over limit\n",
+				bt->cnt_queue_overruns);
 
 			afi_t afi;
 			safi_t safi;
@@ -2751,6 +2845,10 @@ static int bmp_config_write(struct bgp *bgp, struct vty *vty)
 			vty_out(vty, "  bmp stats interval %d\n",
 					bt->stat_msec);
 
+		if (bt->queue_sizelimit != ~0UL)
+			vty_out(vty, "  bmp monitor buffer-limit %zu\n",
+				bt->queue_sizelimit);
+
 		if (bt->mirror)
 			vty_out(vty, "  bmp mirror\n");
 
@@ -2804,6 +2902,8 @@ static int bgp_bmp_init(struct event_loop *tm)
 	install_element(BMP_NODE, &bmp_acl_cmd);
 	install_element(BMP_NODE, &bmp_stats_cmd);
 	install_element(BMP_NODE, &bmp_monitor_cmd);
+	install_element(BMP_NODE, &bmp_monitor_limit_cmd);
+	install_element(BMP_NODE, &no_bmp_monitor_limit_cmd);
 	install_element(BMP_NODE, &bmp_mirror_cmd);
 
 	install_element(BGP_NODE, &bmp_mirror_limit_cmd);
@@ -2878,6 +2978,8 @@ static int bmp_route_update(struct bgp *bgp, afi_t afi, safi_t safi,
 
 				pullwr_bump(bmp->pullwr);
 			};
+
+			bmp_queue_cull(bt);
 		}
 	};
 
@@ -238,6 +238,12 @@ struct bmp_targets {
 	struct bmp_qhash_head locupdhash;
 	struct bmp_qlist_head locupdlist;
 
+	/* memory used by the two queues above is capped at queue_sizelimit;
+	 * sessions falling further behind are disconnected
+	 */
+	size_t queue_sizemax, queue_sizelimit;
+	uint64_t cnt_queue_overruns;
+
 	uint64_t cnt_accept, cnt_aclrefused;
 
 	QOBJ_FIELDS;
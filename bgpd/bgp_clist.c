@@ -106,6 +106,8 @@ static struct community_entry *community_entry_new(void)
 /* Free community list entry.  */
 static void community_entry_free(struct community_entry *entry)
 {
+	community_list_match_cache_flush();
+
 	switch (entry->style) {
 	case COMMUNITY_LIST_STANDARD:
 		if (entry->u.com)
@@ -360,6 +362,8 @@ static void community_list_entry_add(struct community_list *list,
 	struct community_entry *replace;
 	struct community_entry *point;
 
+	community_list_match_cache_flush();
+
 	/* Automatic assignment of seq no. */
 	if (entry->seq == COMMUNITY_SEQ_NUMBER_AUTO)
 		entry->seq = bgp_clist_new_seq_get(list);
@@ -648,7 +652,8 @@ static bool ecommunity_regexp_match(struct ecommunity *ecom, regex_t *reg)
 
 /* When given community attribute matches to the community-list return
    1 else return 0.  */
-bool community_list_match(struct community *com, struct community_list *list)
+static bool community_list_match_walk(struct community *com,
+				      struct community_list *list)
 {
 	struct community_entry *entry;
 
@@ -719,8 +724,8 @@ bool ecommunity_list_match(struct ecommunity *ecom, struct community_list *list)
 
 /* Perform exact matching.  In case of expanded community-list, do
    same thing as community_list_match().  */
-bool community_list_exact_match(struct community *com,
-				struct community_list *list)
+static bool community_list_exact_match_walk(struct community *com,
+					    struct community_list *list)
 {
 	struct community_entry *entry;
 
@@ -736,7 +741,8 @@ bool community_list_exact_match(struct community *com,
 	return false;
 }
 
-bool community_list_any_match(struct community *com, struct community_list *list)
+static bool community_list_any_match_walk(struct community *com,
+					  struct community_list *list)
 {
 	struct community_entry *entry;
 	uint32_t val;
@@ -757,6 +763,120 @@ bool community_list_any_match(struct community *com, struct community_list *list
 	return false;
 }
 
+/*
+ * Community-list match cache.
+ *
+ * Matching an expanded community-list renders the community attribute
+ * to a string and runs every entry's regular expression over it.  With
+ * inbound policy on full-table peers this dominates route-map
+ * evaluation, while interned community values are shared by many paths.
+ * The last verdicts are kept in the interned community itself (see
+ * struct community_match_cache).  Any change to a community-list entry
+ * or a community alias bumps clist_match_gen, which invalidates every
+ * cached verdict at once.
+ */
+enum clist_match_type {
+	CLIST_MATCH,
+	CLIST_MATCH_EXACT,
+	CLIST_MATCH_ANY,
+};
+
+static uint32_t clist_match_gen = 1;
+
+void community_list_match_cache_flush(void)
+{
+	/* 0 marks an unused slot */
+	if (++clist_match_gen == 0)
+		clist_match_gen = 1;
+}
+
+static bool community_list_has_expanded(const struct community_list *list)
+{
+	const struct community_entry *entry;
+
+	for (entry = list->head; entry; entry = entry->next)
+		if (entry->style == COMMUNITY_LIST_EXPANDED)
+			return true;
+	return false;
+}
+
+static bool community_list_match_type(struct community *com,
+				      struct community_list *list,
+				      enum clist_match_type type)
+{
+	switch (type) {
+	case CLIST_MATCH:
+		return community_list_match_walk(com, list);
+	case CLIST_MATCH_EXACT:
+		return community_list_exact_match_walk(com, list);
+	case CLIST_MATCH_ANY:
+		return community_list_any_match_walk(com, list);
+	}
+
+	return false;
+}
+
+static bool community_list_match_cached(struct community *com,
+					struct community_list *list,
+					enum clist_match_type type)
+{
+	struct community_match_cache *mc;
+	bool result;
+	int i;
+
+	/*
+	 * Standard lists are cheaper to walk than to look up.  Communities
+	 * being built by a route-map are not interned and may change under
+	 * us; don't cache those.
+	 */
+	if (!com || !com->refcnt || !community_list_has_expanded(list))
+		return community_list_match_type(com, list, type);
+
+	mc = com->match_cache;
+	for (i = 0; i < COMMUNITY_MATCH_CACHE_SLOTS; i++) {
+		if (mc[i].list != list || mc[i].type != type ||
+		    mc[i].gen != clist_match_gen)
+			continue;
+
+		result = mc[i].result;
+		/* Keep the most recently used verdict first */
+		if (i) {
+			struct community_match_cache hit = mc[i];
+
+			mc[i] = mc[0];
+			mc[0] = hit;
+		}
+		return result;
+	}
+
+	result = community_list_match_type(com, list, type);
+
+	memmove(&mc[1], &mc[0],
+		sizeof(*mc) * (COMMUNITY_MATCH_CACHE_SLOTS - 1));
+	mc[0].list = list;
+	mc[0].type = type;
+	mc[0].gen = clist_match_gen;
+	mc[0].result = result;
+
+	return result;
+}
+
+bool community_list_match(struct community *com, struct community_list *list)
+{
+	return community_list_match_cached(com, list, CLIST_MATCH);
+}
+
+bool community_list_exact_match(struct community *com,
+				struct community_list *list)
+{
+	return community_list_match_cached(com, list, CLIST_MATCH_EXACT);
+}
+
+bool community_list_any_match(struct community *com, struct community_list *list)
+{
+	return community_list_match_cached(com, list, CLIST_MATCH_ANY);
+}
+
 /* Delete all permitted communities in the list from com.  */
 struct community *community_list_match_delete(struct community *com,
 					      struct community_list *list)
@@ -142,9 +142,8 @@ uint32_t community_val_get(struct community *com, int i)
 /* Sort and uniq given community. */
 struct community *community_uniq_sort(struct community *com)
 {
-	int i;
+	int i, j;
 	struct community *new;
-	uint32_t val;
 
 	if (!com)
 		return NULL;
@@ -152,14 +151,22 @@ struct community *community_uniq_sort(struct community *com)
 	new = community_new();
 	new->json = NULL;
 
-	for (i = 0; i < com->size; i++) {
-		val = community_val_get(com, i);
+	if (!com->size)
+		return new;
 
-		if (!community_include(new, val))
-			community_add_val(new, val);
+	/* Sort a copy in one go and squeeze out the duplicates, rather than
+	 * growing the value array one community at a time.
+	 */
+	new->val = XMALLOC(MTYPE_COMMUNITY_VAL, com_length(com));
+	memcpy(new->val, com->val, com_length(com));
+	qsort(new->val, com->size, sizeof(uint32_t), community_compare);
+
+	for (i = 0, j = 0; i < com->size; i++) {
+		if (j && new->val[j - 1] == new->val[i])
+			continue;
+		new->val[j++] = new->val[i];
 	}
-
-	qsort(new->val, new->size, sizeof(uint32_t), community_compare);
+	new->size = j;
 
 	return new;
 }
@@ -930,8 +937,31 @@ void bgp_aggr_community_remove(void *arg)
 void bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
 				     struct community *community)
 {
+	struct community *aggr_community = NULL;
+	struct community *commerge;
+
+	if ((aggregate == NULL) || (community == NULL))
+		return;
+
+	if (aggregate->community_hash)
+		aggr_community = bgp_aggr_community_lookup(aggregate,
+							   community);
+
 	bgp_compute_aggregate_community_hash(aggregate, community);
-	bgp_compute_aggregate_community_val(aggregate);
+
+	/* Already contributed, the aggregate's community is unchanged.
+	 */
+	if (aggr_community)
+		return;
+
+	/* Merge just the new community into the aggregate's.
+	 */
+	if (aggregate->community) {
+		commerge = community_merge(aggregate->community, community);
+		aggregate->community = community_uniq_sort(commerge);
+		community_free(&commerge);
+	} else
+		aggregate->community = community_uniq_sort(community);
 }
 
 
@@ -11,6 +11,19 @@
 #include "bgpd/bgp_attr.h"
 
 /* Communities attribute.  */
+/* Verdict of a community-list on an interned community, kept by
+ * bgp_clist.c.  Only valid while 'gen' matches the community-list
+ * generation.
+ */
+struct community_match_cache {
+	const void *list;
+	uint32_t gen;
+	uint8_t type;
+	bool result;
+};
+
+#define COMMUNITY_MATCH_CACHE_SLOTS 2
+
 struct community {
 	/* Reference count of communities value.  */
 	unsigned long refcnt;
@@ -27,6 +40,9 @@ struct community {
 	/* String of community attribute.  This sring is used by vty output
 	   and expanded community-list for regular expression match.  */
 	char *str;
+
+	/* Most recently used community-list verdicts first */
+	struct community_match_cache match_cache[COMMUNITY_MATCH_CACHE_SLOTS];
 };
 
 /* Well-known communities value.  */
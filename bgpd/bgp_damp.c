@@ -25,11 +25,6 @@
 /* Global variable to access damping configuration */
 static struct bgp_damp_config damp[AFI_MAX][SAFI_MAX];
 
-/* Utility macro to add and delete BGP dampening information to no
-   used list.  */
-#define BGP_DAMP_LIST_ADD(N, A) BGP_PATH_INFO_ADD(N, A, no_reuse_list)
-#define BGP_DAMP_LIST_DEL(N, A) BGP_PATH_INFO_DEL(N, A, no_reuse_list)
-
 /* Calculate reuse list index by penalty value.  */
 static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
 {
@@ -53,14 +48,10 @@ static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
 	return (bdc->reuse_offset + index) % bdc->reuse_list_size;
 }
 
-/* Add BGP dampening information to reuse list.  */
-static void bgp_reuse_list_add(struct bgp_damp_info *bdi,
-			       struct bgp_damp_config *bdc)
+static void bgp_reuse_list_insert(struct bgp_damp_info *bdi,
+				  struct bgp_damp_config *bdc, int index)
 {
-	int index;
-
-	index = bdi->index = bgp_reuse_index(bdi->penalty, bdc);
-
+	bdi->index = index;
 	bdi->prev = NULL;
 	bdi->next = bdc->reuse_list[index];
 	if (bdc->reuse_list[index])
@@ -68,16 +59,49 @@ static void bgp_reuse_list_add(struct bgp_damp_info *bdi,
 	bdc->reuse_list[index] = bdi;
 }
 
+/* Add BGP dampening information to reuse list.  */
+static void bgp_reuse_list_add(struct bgp_damp_info *bdi,
+			       struct bgp_damp_config *bdc)
+{
+	bgp_reuse_list_insert(bdi, bdc, bgp_reuse_index(bdi->penalty, bdc));
+}
+
+/* Routes which are not suppressed sit on the same lists, in the slot at
+ * which their penalty will have decayed to half of the reuse limit; the
+ * reuse timer then forgets their history (RFC2439 Section 4.8.7) without
+ * anything having to walk over every flapped path.  Decaying to
+ * reuse_limit / 2 takes as long as decaying twice the penalty down to
+ * reuse_limit, which is what bgp_reuse_index() knows how to compute.
+ */
+static void bgp_forget_list_add(struct bgp_damp_info *bdi,
+				struct bgp_damp_config *bdc)
+{
+	unsigned int penalty = bdi->penalty * 2;
+
+	/* Already below the threshold: look at it on the next tick. */
+	if (penalty < bdc->reuse_limit)
+		penalty = bdc->reuse_limit;
+
+	bgp_reuse_list_insert(bdi, bdc, bgp_reuse_index(penalty, bdc));
+}
+
 /* Delete BGP dampening information from reuse list.  */
 static void bgp_reuse_list_delete(struct bgp_damp_info *bdi,
 				  struct bgp_damp_config *bdc)
 {
+	/* Already unlinked by the reuse timer. */
+	if (bdi->index < 0)
+		return;
+
 	if (bdi->next)
 		bdi->next->prev = bdi->prev;
 	if (bdi->prev)
 		bdi->prev->next = bdi->next;
 	else
 		bdc->reuse_list[bdi->index] = bdi->next;
+
+	bdi->next = bdi->prev = NULL;
+	bdi->index = -1;
 }
 
 /* Return decayed penalty value.  */
@@ -93,7 +117,8 @@ int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 	if (i >= bdc->decay_array_size)
 		return 0;
 
-	return (int)(penalty * bdc->decay_array[i]);
+	return (int)(((uint64_t)penalty * bdc->decay_array[i])
+		     >> BGP_DAMP_DECAY_SHIFT);
 }
 
 /* Handler of reuse timer event.  Each route in the current reuse-list
@@ -123,9 +148,15 @@ static void bgp_reuse_timer(struct event *t)
 
 	/* 3. if ( the saved list head pointer is non-empty ) */
 	for (; bdi; bdi = next) {
+		struct bgp_dest *dest = bdi->dest;
 		struct bgp *bgp = bdi->path->peer->bgp;
+		afi_t afi = bdi->afi;
+		safi_t safi = bdi->safi;
+		bool removed;
 
 		next = bdi->next;
+		bdi->next = bdi->prev = NULL;
+		bdi->index = -1;
 
 		/* Set t-diff = t-now - t-updated.  */
 		t_diff = t_now - bdi->t_updated;
@@ -137,27 +168,43 @@ static void bgp_reuse_timer(struct event *t)
 		/* Set t-updated = t-now.  */
 		bdi->t_updated = t_now;
 
+		/* Not suppressed, only waiting for its history to expire. */
+		if (!CHECK_FLAG(bdi->path->flags, BGP_PATH_DAMPED)) {
+			if (bdi->penalty > bdc->reuse_limit / 2.0) {
+				bgp_forget_list_add(bdi, bdc);
+				continue;
+			}
+
+			removed = bdi->lastrecord == BGP_RECORD_WITHDRAW;
+			bgp_damp_info_free(bdi, 1, afi, safi);
+			if (removed)
+				bgp_process(bgp, dest, afi, safi);
+			continue;
+		}
+
 		/* if (figure-of-merit < reuse).  */
 		if (bdi->penalty < bdc->reuse_limit) {
 			/* Reuse the route.  */
-			bgp_path_info_unset_flag(bdi->dest, bdi->path,
+			bgp_path_info_unset_flag(dest, bdi->path,
 						 BGP_PATH_DAMPED);
 			bdi->suppress_time = 0;
 
 			if (bdi->lastrecord == BGP_RECORD_UPDATE) {
-				bgp_path_info_unset_flag(bdi->dest, bdi->path,
+				bgp_path_info_unset_flag(dest, bdi->path,
 							 BGP_PATH_HISTORY);
 				bgp_aggregate_increment(
-					bgp, bgp_dest_get_prefix(bdi->dest),
-					bdi->path, bdi->afi, bdi->safi);
-				bgp_process(bgp, bdi->dest, bdi->afi,
-					    bdi->safi);
+					bgp, bgp_dest_get_prefix(dest),
+					bdi->path, afi, safi);
+				bgp_process(bgp, dest, afi, safi);
 			}
 
-			if (bdi->penalty <= bdc->reuse_limit / 2.0)
-				bgp_damp_info_free(bdi, 1, bdc->afi, bdc->safi);
-			else
-				BGP_DAMP_LIST_ADD(bdc, bdi);
+			if (bdi->penalty <= bdc->reuse_limit / 2.0) {
+				removed = bdi->lastrecord == BGP_RECORD_WITHDRAW;
+				bgp_damp_info_free(bdi, 1, afi, safi);
+				if (removed)
+					bgp_process(bgp, dest, afi, safi);
+			} else
+				bgp_forget_list_add(bdi, bdc);
 		} else
 			/* Re-insert into another list (See RFC2439 Section
 			 * 4.8.6).  */
@@ -201,7 +248,6 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 		bdi->afi = afi;
 		bdi->safi = safi;
 		(bgp_path_info_extra_get(path))->damp_info = bdi;
-		BGP_DAMP_LIST_ADD(bdc, bdi);
 	} else {
 		last_penalty = bdi->penalty;
 
@@ -237,12 +283,13 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 
 	/* If not suppressed before, do annonunce this withdraw and
 	   insert into reuse_list.  */
+	bgp_reuse_list_delete(bdi, bdc);
 	if (bdi->penalty >= bdc->suppress_value) {
 		bgp_path_info_set_flag(dest, path, BGP_PATH_DAMPED);
 		bdi->suppress_time = t_now;
-		BGP_DAMP_LIST_DEL(bdc, bdi);
 		bgp_reuse_list_add(bdi, bdc);
-	}
+	} else
+		bgp_forget_list_add(bdi, bdc);
 
 	return BGP_DAMP_USED;
 }
@@ -272,7 +319,7 @@ int bgp_damp_update(struct bgp_path_info *path, struct bgp_dest *dest,
 		 && (bdi->penalty < bdc->reuse_limit)) {
 		bgp_path_info_unset_flag(dest, path, BGP_PATH_DAMPED);
 		bgp_reuse_list_delete(bdi, bdc);
-		BGP_DAMP_LIST_ADD(bdc, bdi);
+		bgp_forget_list_add(bdi, bdc);
 		bdi->suppress_time = 0;
 		status = BGP_DAMP_USED;
 	} else
@@ -298,10 +345,7 @@ void bgp_damp_info_free(struct bgp_damp_info *bdi, int withdraw, afi_t afi,
 	path = bdi->path;
 	path->extra->damp_info = NULL;
 
-	if (CHECK_FLAG(path->flags, BGP_PATH_DAMPED))
-		bgp_reuse_list_delete(bdi, bdc);
-	else
-		BGP_DAMP_LIST_DEL(bdc, bdi);
+	bgp_reuse_list_delete(bdi, bdc);
 
 	bgp_path_info_unset_flag(bdi->dest, path,
 				 BGP_PATH_HISTORY | BGP_PATH_DAMPED);
@@ -319,6 +363,7 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 	double reuse_max_ratio;
 	unsigned int i;
 	double j;
+	double decay;
 
 	bdc->suppress_value = sup;
 	bdc->half_life = hlife;
@@ -332,18 +377,20 @@ static void bgp_damp_parameter_set(time_t hlife, unsigned int reuse,
 			     * (pow(2, (double)bdc->max_suppress_time
 					       / bdc->half_life)));
 
-	/* Decay-array computations */
+	/* Decay-array computations, kept in fixed point so that decaying a
+	 * penalty is a multiply and a shift.
+	 */
 	bdc->decay_array_size = ceil((double)bdc->max_suppress_time / DELTA_T);
+	if (bdc->decay_array_size < 2)
+		bdc->decay_array_size = 2;
 	bdc->decay_array = XMALLOC(MTYPE_BGP_DAMP_ARRAY,
-				   sizeof(double) * (bdc->decay_array_size));
-	bdc->decay_array[0] = 1.0;
-	bdc->decay_array[1] =
-		exp((1.0 / ((double)bdc->half_life / DELTA_T)) * log(0.5));
+				   sizeof(uint32_t) * (bdc->decay_array_size));
+	decay = exp((1.0 / ((double)bdc->half_life / DELTA_T)) * log(0.5));
 
 	/* Calculate decay values for all possible times */
-	for (i = 2; i < bdc->decay_array_size; i++)
+	for (i = 0, j = 1.0; i < bdc->decay_array_size; i++, j *= decay)
 		bdc->decay_array[i] =
-			bdc->decay_array[i - 1] * bdc->decay_array[1];
+			(uint32_t)(j * (1U << BGP_DAMP_DECAY_SHIFT) + 0.5);
 
 	/* Reuse-list computations */
 	i = ceil((double)bdc->max_suppress_time / DELTA_REUSE) + 1;
@@ -435,12 +482,6 @@ void bgp_damp_info_clean(afi_t afi, safi_t safi)
 		}
 		bdc->reuse_list[i] = NULL;
 	}
-
-	for (bdi = bdc->no_reuse_list; bdi; bdi = next) {
-		next = bdi->next;
-		bgp_damp_info_free(bdi, 1, afi, safi);
-	}
-	bdc->no_reuse_list = NULL;
 }
 
 int bgp_damp_disable(struct bgp *bgp, afi_t afi, safi_t safi)
@@ -495,10 +536,10 @@ static const char *bgp_get_reuse_time(unsigned int penalty, char *buf,
 	int time_store = 0;
 
 	if (penalty > damp[afi][safi].reuse_limit) {
-		reuse_time = (int)(DELTA_T
+		reuse_time = (int)(damp[afi][safi].half_life
 				   * ((log((double)damp[afi][safi].reuse_limit
 					   / penalty))
-				      / (log(damp[afi][safi].decay_array[1]))));
+				      / log(0.5)));
 
 		if (reuse_time > damp[afi][safi].max_suppress_time)
 			reuse_time = damp[afi][safi].max_suppress_time;
@@ -10,8 +10,10 @@
 
 /* Structure maintained on a per-route basis. */
 struct bgp_damp_info {
-	/* Doubly linked list.  This information must be linked to
-	   reuse_list or no_reuse_list.  */
+	/* Doubly linked list.  This information must be linked to one of
+	   the reuse_list slots: the one at which a suppressed route is
+	   reused, or the one at which the history of a route that is not
+	   suppressed is forgotten.  */
 	struct bgp_damp_info *next;
 	struct bgp_damp_info *prev;
 
@@ -78,8 +80,8 @@ struct bgp_damp_config {
 	double scale_factor;
 	unsigned int reuse_scale_factor;
 
-	/* Decay array per-set based. */
-	double *decay_array;
+	/* Decay array per-set based, scaled by 2^BGP_DAMP_DECAY_SHIFT. */
+	uint32_t *decay_array;
 
 	/* Reuse index array per-set based. */
 	int *reuse_index;
@@ -88,9 +90,6 @@ struct bgp_damp_config {
 	struct bgp_damp_info **reuse_list;
 	int reuse_offset;
 
-	/* All dampening information which is not on reuse list.  */
-	struct bgp_damp_info *no_reuse_list;
-
 	/* Reuse timer thread per-set base. */
 	struct event *t_reuse;
 
@@ -108,6 +107,9 @@ struct bgp_damp_config {
 /* Time granularity for decay arrays */
 #define DELTA_T 	           5
 
+/* Fixed point precision of the decay array */
+#define BGP_DAMP_DECAY_SHIFT      24
+
 #define DEFAULT_PENALTY         1000
 
 #define DEFAULT_HALF_LIFE         15
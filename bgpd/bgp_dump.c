@@ -70,8 +70,20 @@ struct bgp_dump {
 	char *interval_str;
 
 	struct event *t_interval;
+
+	/* State of a "routes-mrt" table dump in progress */
+	struct event *t_routes;
+	struct bgp *routes_bgp;
+	struct bgp_dest *routes_dest;
+	afi_t routes_afi;
+	unsigned int routes_seq;
 };
 
+/* stdio buffer for table dumps, so the RIB walk doesn't issue a write(2)
+ * for every few records
+ */
+#define BGP_DUMP_ROUTES_BUFSIZ (1024 * 1024)
+
 static int bgp_dump_unset(struct bgp_dump *bgp_dump);
 static void bgp_dump_interval_func(struct event *);
 
@@ -292,8 +304,8 @@ static void bgp_dump_routes_index_table(struct bgp *bgp)
 }
 
 static struct bgp_path_info *
-bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
-			   struct bgp_path_info *path, unsigned int seq)
+bgp_dump_route_node_record(struct bgp *bgp, int afi, struct bgp_dest *dest,
+			   struct bgp_path_info *path, unsigned int *seq)
 {
 	struct stream *obuf;
 	size_t sizep;
@@ -325,7 +337,7 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 				BGP_DUMP_ROUTES);
 
 	/* Sequence number */
-	stream_putl(obuf, seq);
+	stream_putl(obuf, *seq);
 
 	/* Prefix length */
 	stream_putc(obuf, p->prefixlen);
@@ -356,6 +368,13 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 	for (; path; path = path->next) {
 		size_t cur_endp;
 
+		/* The dump runs in slices; skip peers created after the peer
+		 * index table was written, they have no index to refer to.
+		 */
+		if (!path->peer->table_dump_index &&
+		    path->peer != bgp->peer_self)
+			continue;
+
 		/* Peer index */
 		stream_putw(obuf, path->peer->table_dump_index);
 
@@ -383,53 +402,108 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 		endp = cur_endp;
 	}
 
+	if (!entry_count)
+		return path;
+
 	/* Overwrite the entry count, now that we know the right number */
 	stream_putw_at(obuf, sizep, entry_count);
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
 	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
+	(*seq)++;
 
 	return path;
 }
 
+/* Stop a table dump, whether it completed or not. */
+static void bgp_dump_routes_stop(struct bgp_dump *bgp_dump)
+{
+	EVENT_OFF(bgp_dump->t_routes);
+
+	if (bgp_dump->routes_dest) {
+		bgp_dest_unlock_node(bgp_dump->routes_dest);
+		bgp_dump->routes_dest = NULL;
+	}
+
+	if (bgp_dump->routes_bgp) {
+		bgp_unlock(bgp_dump->routes_bgp);
+		bgp_dump->routes_bgp = NULL;
+	}
+
+	/* Close the file now. For a RIB dump there's no point in leaving
+	 * it open until the next scheduled dump starts. */
+	if (bgp_dump->fp) {
+		fclose(bgp_dump->fp);
+		bgp_dump->fp = NULL;
+	}
+}
 
-/* Runs under child process. */
-static unsigned int bgp_dump_routes_func(int afi, int first_run,
-					 unsigned int seq)
+/*
+ * Walk the RIB and write it out, yielding back to the event loop whenever
+ * our time slice is used up so that a large table does not hold up
+ * protocol processing.  The position is kept as a locked bgp_dest; the
+ * dump reflects the table as it is while being walked, like any show
+ * command would.
+ */
+static void bgp_dump_routes_func(struct event *t)
 {
+	struct bgp_dump *bgp_dump = EVENT_ARG(t);
+	struct bgp *bgp = bgp_dump->routes_bgp;
+	afi_t afi = bgp_dump->routes_afi;
 	struct bgp_path_info *path;
 	struct bgp_dest *dest;
-	struct bgp *bgp;
-	struct bgp_table *table;
 
-	bgp = bgp_get_default();
-	if (!bgp)
-		return seq;
+	if (bgp_dump->routes_dest)
+		dest = bgp_route_next(bgp_dump->routes_dest);
+	else
+		dest = bgp_table_top(bgp->rib[afi][SAFI_UNICAST]);
+	bgp_dump->routes_dest = NULL;
 
-	if (bgp_dump_routes.fp == NULL)
-		return seq;
+	for (; dest; dest = bgp_route_next(dest)) {
+		path = bgp_dest_get_bgp_path_info(dest);
+		while (path)
+			path = bgp_dump_route_node_record(bgp, afi, dest, path,
+							  &bgp_dump->routes_seq);
+
+		if (event_should_yield(t)) {
+			/* keeps the lock taken by bgp_route_next() */
+			bgp_dump->routes_dest = dest;
+			event_add_event(bm->master, bgp_dump_routes_func,
+					bgp_dump, 0, &bgp_dump->t_routes);
+			return;
+		}
+	}
 
-	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers,
-	   so this should only be done on the first call to
-	   bgp_dump_routes_func.
-	   ( this function will be called once for ipv4 and once for ipv6 ) */
-	if (first_run)
-		bgp_dump_routes_index_table(bgp);
+	if (afi == AFI_IP) {
+		bgp_dump->routes_afi = AFI_IP6;
+		event_add_event(bm->master, bgp_dump_routes_func, bgp_dump, 0,
+				&bgp_dump->t_routes);
+		return;
+	}
 
-	/* Walk down each BGP route. */
-	table = bgp->rib[afi][SAFI_UNICAST];
+	bgp_dump_routes_stop(bgp_dump);
+}
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		path = bgp_dest_get_bgp_path_info(dest);
-		while (path) {
-			path = bgp_dump_route_node_record(afi, dest, path, seq);
-			seq++;
-		}
+static void bgp_dump_routes_start(struct bgp_dump *bgp_dump)
+{
+	struct bgp *bgp;
+
+	bgp = bgp_get_default();
+	if (!bgp) {
+		bgp_dump_routes_stop(bgp_dump);
+		return;
 	}
 
-	fflush(bgp_dump_routes.fp);
+	setvbuf(bgp_dump->fp, NULL, _IOFBF, BGP_DUMP_ROUTES_BUFSIZ);
+
+	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers */
+	bgp_dump_routes_index_table(bgp);
 
-	return seq;
+	bgp_dump->routes_bgp = bgp_lock(bgp);
+	bgp_dump->routes_afi = AFI_IP;
+	bgp_dump->routes_seq = 0;
+	event_add_event(bm->master, bgp_dump_routes_func, bgp_dump, 0,
+			&bgp_dump->t_routes);
 }
 
 static void bgp_dump_interval_func(struct event *t)
@@ -437,21 +511,23 @@ static void bgp_dump_interval_func(struct event *t)
 	struct bgp_dump *bgp_dump;
 	bgp_dump = EVENT_ARG(t);
 
+	/* Don't pull the file out from under a table dump still running */
+	if (bgp_dump->type == BGP_DUMP_ROUTES && bgp_dump->routes_bgp) {
+		flog_warn(EC_BGP_DUMP,
+			  "%s: previous routes-mrt dump still in progress, skipping this interval",
+			  __func__);
+		goto reschedule;
+	}
+
 	/* Reschedule dump even if file couldn't be opened this time... */
 	if (bgp_dump_open_file(bgp_dump) != NULL) {
 		/* In case of bgp_dump_routes, we need special route dump
 		 * function. */
-		if (bgp_dump->type == BGP_DUMP_ROUTES) {
-			unsigned int seq = bgp_dump_routes_func(AFI_IP, 1, 0);
-			bgp_dump_routes_func(AFI_IP6, 0, seq);
-			/* Close the file now. For a RIB dump there's no point
-			 * in leaving
-			 * it open until the next scheduled dump starts. */
-			fclose(bgp_dump->fp);
-			bgp_dump->fp = NULL;
-		}
+		if (bgp_dump->type == BGP_DUMP_ROUTES)
+			bgp_dump_routes_start(bgp_dump);
 	}
 
+reschedule:
 	/* if interval is set reschedule */
 	if (bgp_dump->interval > 0)
 		bgp_dump_interval_add(bgp_dump, bgp_dump->interval);
@@ -687,6 +763,9 @@ static int bgp_dump_set(struct vty *vty, struct bgp_dump *bgp_dump,
 
 static int bgp_dump_unset(struct bgp_dump *bgp_dump)
 {
+	/* Abort a table dump in progress. */
+	bgp_dump_routes_stop(bgp_dump);
+
 	/* Removing file name. */
 	XFREE(MTYPE_BGP_DUMP_STR, bgp_dump->filename);
 
@@ -1656,8 +1656,31 @@ void bgp_aggr_ecommunity_remove(void *arg)
 void bgp_compute_aggregate_ecommunity(struct bgp_aggregate *aggregate,
 				      struct ecommunity *ecommunity)
 {
+	struct ecommunity *aggr_ecommunity = NULL;
+	struct ecommunity *ecommerge;
+
+	if ((aggregate == NULL) || (ecommunity == NULL))
+		return;
+
+	if (aggregate->ecommunity_hash)
+		aggr_ecommunity = bgp_aggr_ecommunity_lookup(aggregate,
+							     ecommunity);
+
 	bgp_compute_aggregate_ecommunity_hash(aggregate, ecommunity);
-	bgp_compute_aggregate_ecommunity_val(aggregate);
+
+	/* Already contributed, the aggregate's ecommunity is unchanged.
+	 */
+	if (aggr_ecommunity)
+		return;
+
+	/* Merge just the new ecommunity into the aggregate's.
+	 */
+	if (aggregate->ecommunity) {
+		ecommerge = ecommunity_merge(aggregate->ecommunity, ecommunity);
+		aggregate->ecommunity = ecommunity_uniq_sort(ecommerge);
+		ecommunity_free(&ecommerge);
+	} else
+		aggregate->ecommunity = ecommunity_uniq_sort(ecommunity);
 }
 
 
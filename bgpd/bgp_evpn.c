@@ -2897,8 +2897,8 @@ bgp_create_evpn_bgp_path_info(struct bgp_path_info *parent_pi,
 		memcpy(&pi->extra->label, &parent_pi->extra->label,
 		       sizeof(pi->extra->label));
 		pi->extra->num_labels = parent_pi->extra->num_labels;
-		pi->extra->igpmetric = parent_pi->extra->igpmetric;
 	}
+	pi->igpmetric = parent_pi->igpmetric;
 
 	bgp_path_info_add(dest, pi);
 
@@ -3987,7 +3987,8 @@ static int uninstall_routes_for_vni(struct bgp *bgp, struct bgpevpn *vpn)
 static int install_uninstall_route_in_vrfs(struct bgp *bgp_def, afi_t afi,
 					   safi_t safi, struct prefix_evpn *evp,
 					   struct bgp_path_info *pi,
-					   struct list *vrfs, int install)
+					   struct list *vrfs, int install,
+					   uint32_t walk)
 {
 	struct bgp *bgp_vrf;
 	struct listnode *node, *nnode;
@@ -4006,6 +4007,11 @@ static int install_uninstall_route_in_vrfs(struct bgp *bgp_def, afi_t afi,
 	for (ALL_LIST_ELEMENTS(vrfs, node, nnode, bgp_vrf)) {
 		int ret;
 
+		/* already handled via another RT of this route */
+		if (bgp_vrf->evpn_info->import_walk == walk)
+			continue;
+		bgp_vrf->evpn_info->import_walk = walk;
+
 		/* don't import hosts that are locally attached */
 		if (install && bgp_evpn_skip_vrf_import_of_local_es(
 				       bgp_vrf, evp, pi, install))
@@ -4036,7 +4042,8 @@ static int install_uninstall_route_in_vrfs(struct bgp *bgp_def, afi_t afi,
 static int install_uninstall_route_in_vnis(struct bgp *bgp, afi_t afi,
 					   safi_t safi, struct prefix_evpn *evp,
 					   struct bgp_path_info *pi,
-					   struct list *vnis, int install)
+					   struct list *vnis, int install,
+					   uint32_t walk)
 {
 	struct bgpevpn *vpn;
 	struct listnode *node, *nnode;
@@ -4047,6 +4054,11 @@ static int install_uninstall_route_in_vnis(struct bgp *bgp, afi_t afi,
 		if (!is_vni_live(vpn))
 			continue;
 
+		/* already handled via another RT of this route */
+		if (vpn->import_walk == walk)
+			continue;
+		vpn->import_walk = walk;
+
 		if (install)
 			ret = install_evpn_route_entry(bgp, vpn, evp, pi);
 		else
@@ -4081,6 +4093,9 @@ static int bgp_evpn_install_uninstall_table(struct bgp *bgp, afi_t afi,
 	struct ecommunity *ecom;
 	uint32_t i;
 	struct prefix_evpn ad_evp;
+	static uint32_t import_walk;
+	uint32_t walk;
+	bool es_linked = false;
 
 	assert(attr);
 
@@ -4115,6 +4130,13 @@ static int bgp_evpn_install_uninstall_table(struct bgp *bgp, afi_t afi,
 	if (import && bgp_evpn_route_matches_macvrf_soo(pi, evp))
 		return 0;
 
+	/* Stamp for the VNIs and VRFs visited by this route, 0 is never
+	 * used so that freshly created ones are not mistaken as visited.
+	 */
+	if (++import_walk == 0)
+		import_walk++;
+	walk = import_walk;
+
 	/* An EVPN route belongs to a VNI or a VRF or an ESI based on the RTs
 	 * attached to the route */
 	for (i = 0; i < ecom->size; i++) {
@@ -4138,9 +4160,12 @@ static int bgp_evpn_install_uninstall_table(struct bgp *bgp, afi_t afi,
 		/* non-local MAC-IP routes in the global route table are linked
 		 * to the destination ES
 		 */
-		if (evp->prefix.route_type == BGP_EVPN_MAC_IP_ROUTE)
+		if (evp->prefix.route_type == BGP_EVPN_MAC_IP_ROUTE &&
+		    !es_linked) {
 			bgp_evpn_path_es_link(pi, 0,
 					      bgp_evpn_attr_get_esi(pi->attr));
+			es_linked = true;
+		}
 
 		/*
 		 * macip routes (type-2) are imported into VNI and VRF tables.
@@ -4156,13 +4181,13 @@ static int bgp_evpn_install_uninstall_table(struct bgp *bgp, afi_t afi,
 			if (irt)
 				install_uninstall_route_in_vnis(
 					bgp, afi, safi, evp, pi, irt->vnis,
-					import);
+					import, walk);
 
 			vrf_irt = in_vrf_rt ? lookup_vrf_import_rt(eval) : NULL;
 			if (vrf_irt)
 				install_uninstall_route_in_vrfs(
 					bgp, afi, safi, evp, pi, vrf_irt->vrfs,
-					import);
+					import, walk);
 
 			/* Also check for non-exact match.
 			 * In this, we mask out the AS and
@@ -4187,11 +4212,11 @@ static int bgp_evpn_install_uninstall_table(struct bgp *bgp, afi_t afi,
 			if (irt)
 				install_uninstall_route_in_vnis(
 					bgp, afi, safi, evp, pi, irt->vnis,
-					import);
+					import, walk);
 			if (vrf_irt)
 				install_uninstall_route_in_vrfs(
 					bgp, afi, safi, evp, pi, vrf_irt->vrfs,
-					import);
+					import, walk);
 		}
 
 		/* es route is imported into the es table */
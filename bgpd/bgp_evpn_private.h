@@ -108,6 +108,12 @@ struct bgpevpn {
 	/* List of local ESs */
 	struct list *local_es_evi_list;
 
+	/* Last route import that visited this VNI. A route whose RTs map
+	 * to the same VNI more than once (several RTs, or an exact and a
+	 * masked match) is only installed into it once.
+	 */
+	uint32_t import_walk;
+
 	QOBJ_FIELDS;
 };
 
@@ -179,6 +185,9 @@ struct bgp_evpn_info {
 	struct ethaddr pip_rmac_static;
 	struct ethaddr pip_rmac_zebra;
 	bool is_anycast_mac;
+
+	/* Last route import that visited this VRF, see bgpevpn */
+	uint32_t import_walk;
 };
 
 /* This structure defines an entry in remote_ip_hash */
@@ -73,6 +73,25 @@ static struct as_list_master as_list_master = {{NULL, NULL},
 					       NULL,
 					       NULL};
 
+/*
+ * AS path filter result cache.
+ *
+ * Every as-path access-list entry is a regular expression run over the
+ * string form of the AS path, so applying a list to a full table is
+ * expensive.  Interned AS paths are shared by many paths, though, so the
+ * last verdicts are kept in the interned aspath itself (see struct
+ * aspath_filter_cache).  Any change to any as-path access-list bumps
+ * as_list_gen, which invalidates every cached verdict at once.
+ */
+static uint32_t as_list_gen = 1;
+
+static void as_list_cache_flush(void)
+{
+	/* 0 marks an unused slot */
+	if (++as_list_gen == 0)
+		as_list_gen = 1;
+}
+
 /* Allocate new AS filter. */
 static struct as_filter *as_filter_new(void)
 {
@@ -82,6 +101,8 @@ static struct as_filter *as_filter_new(void)
 /* Free allocated AS filter. */
 static void as_filter_free(struct as_filter *asfilter)
 {
+	as_list_cache_flush();
+
 	if (asfilter->reg)
 		bgp_regex_free(asfilter->reg);
 	XFREE(MTYPE_AS_FILTER_STR, asfilter->reg_str);
@@ -143,6 +164,8 @@ static void as_list_filter_add(struct as_list *aslist,
 	struct as_filter *point;
 	struct as_filter *replace;
 
+	as_list_cache_flush();
+
 	if (aslist->tail && asfilter->seq > aslist->tail->seq)
 		point = NULL;
 	else {
@@ -205,6 +228,9 @@ static struct as_list *as_list_new(void)
 
 static void as_list_free(struct as_list *aslist)
 {
+	/* The pointer may be reused by a new list */
+	as_list_cache_flush();
+
 	XFREE(MTYPE_AS_STR, aslist->name);
 	XFREE(MTYPE_AS_LIST, aslist);
 }
@@ -348,22 +374,62 @@ static bool as_filter_match(struct as_filter *asfilter, struct aspath *aspath)
 	return bgp_regexec(asfilter->reg, aspath) != REG_NOMATCH;
 }
 
+static enum as_filter_type as_list_apply_walk(struct as_list *aslist,
+					      struct aspath *aspath)
+{
+	struct as_filter *asfilter;
+
+	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
+		if (as_filter_match(asfilter, aspath))
+			return asfilter->type;
+	}
+	return AS_FILTER_DENY;
+}
+
 /* Apply AS path filter to AS. */
 enum as_filter_type as_list_apply(struct as_list *aslist, void *object)
 {
-	struct as_filter *asfilter;
+	struct aspath_filter_cache *fc;
 	struct aspath *aspath;
+	enum as_filter_type type;
+	int i;
 
 	aspath = (struct aspath *)object;
 
 	if (aslist == NULL)
 		return AS_FILTER_DENY;
 
-	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
-		if (as_filter_match(asfilter, aspath))
-			return asfilter->type;
+	/*
+	 * Paths being modified by a route-map (e.g. prepend) are not
+	 * interned and may change under us; don't cache those.
+	 */
+	if (!aspath || !aspath->refcnt)
+		return as_list_apply_walk(aslist, aspath);
+
+	fc = aspath->filter_cache;
+	for (i = 0; i < ASPATH_FILTER_CACHE_SLOTS; i++) {
+		if (fc[i].aslist != aslist || fc[i].gen != as_list_gen)
+			continue;
+
+		type = fc[i].type;
+		/* Keep the most recently used verdict first */
+		if (i) {
+			fc[i] = fc[0];
+			fc[0].aslist = aslist;
+			fc[0].gen = as_list_gen;
+			fc[0].type = type;
+		}
+		return type;
 	}
-	return AS_FILTER_DENY;
+
+	type = as_list_apply_walk(aslist, aspath);
+
+	memmove(&fc[1], &fc[0], sizeof(*fc) * (ASPATH_FILTER_CACHE_SLOTS - 1));
+	fc[0].aslist = aslist;
+	fc[0].gen = as_list_gen;
+	fc[0].type = type;
+
+	return type;
 }
 
 /* Add hook function. */
@@ -154,7 +154,15 @@ static void bgp_process_writes(struct event *thread)
 	}
 }
 
-static int read_ibuf_work(struct peer_connection *connection)
+/*
+ * Frame one packet from the work buffer onto the local batch 'pkts'.
+ *
+ * 'queued' is the number of packets already waiting for the main pthread
+ * plus those framed in this batch; it is used to enforce bm->inq_limit
+ * without taking io_mtx for every packet.
+ */
+static int read_ibuf_work(struct peer_connection *connection,
+			  struct stream_fifo *pkts, size_t *queued)
 {
 	/* static buffer for transferring packets */
 	/* shorter alias to peer's input buffer */
@@ -164,10 +172,8 @@ static int read_ibuf_work(struct peer_connection *connection)
 	struct stream *pkt;
 
 	/* ============================================== */
-	frr_with_mutex (&connection->io_mtx) {
-		if (connection->ibuf->count >= bm->inq_limit)
-			return -ENOMEM;
-	}
+	if (*queued >= bm->inq_limit)
+		return -ENOMEM;
 
 	/* check that we have enough data for a header */
 	if (ringbuf_remain(ibw) < BGP_HEADER_SIZE)
@@ -200,9 +206,8 @@ static int read_ibuf_work(struct peer_connection *connection)
 	stream_set_endp(pkt, pktsize);
 
 	frrtrace(2, frr_bgp, packet_read, connection->peer, pkt);
-	frr_with_mutex (&connection->io_mtx) {
-		stream_fifo_push(connection->ibuf, pkt);
-	}
+	stream_fifo_push(pkts, pkt);
+	(*queued)++;
 
 	return pktsize;
 }
@@ -226,6 +231,9 @@ static void bgp_process_reads(struct event *thread)
 	int code = 0;                   /* FSM code if error occurred */
 	static bool ibuf_full_logged;   /* Have we logged full already */
 	int ret = 1;
+	struct stream_fifo pkts;        /* packets framed in this run */
+	struct stream *pkt;
+	size_t queued;                  /* packets waiting for main pthread */
 	/* clang-format on */
 
 	peer = connection->peer;
@@ -257,14 +265,31 @@ static void bgp_process_reads(struct event *thread)
 		goto done;
 	}
 
+	frr_with_mutex (&connection->io_mtx) {
+		queued = connection->ibuf->count;
+	}
+
+	stream_fifo_init(&pkts);
+
 	while (true) {
-		ret = read_ibuf_work(connection);
+		ret = read_ibuf_work(connection, &pkts, &queued);
 		if (ret <= 0)
 			break;
+	}
 
+	/* Hand the whole batch over to the main pthread at once, rather than
+	 * contending on io_mtx with bgp_process_packet() for every packet.
+	 */
+	if (pkts.count) {
+		frr_with_mutex (&connection->io_mtx) {
+			while ((pkt = stream_fifo_pop(&pkts)))
+				stream_fifo_push(connection->ibuf, pkt);
+		}
 		added_pkt = true;
 	}
 
+	stream_fifo_deinit(&pkts);
+
 	switch (ret) {
 	case -EBADMSG:
 		fatal = true;
@@ -329,6 +354,8 @@ static uint16_t bgp_write(struct peer_connection *connection)
 	unsigned int strmsz;
 	unsigned int total_written;
 	time_t now;
+	struct msghdr msg = {};
+	int flags = 0;
 
 	wpkt_quanta_old = atomic_load_explicit(&peer->bgp->wpkt_quanta,
 					       memory_order_relaxed);
@@ -355,8 +382,22 @@ static uint16_t bgp_write(struct peer_connection *connection)
 	strmsz = iovsz;
 	total_written = 0;
 
+#ifdef MSG_MORE
+	/* More packets are queued behind this batch and will be written as
+	 * soon as the socket is writable again, so let the kernel hold back
+	 * a trailing partial segment instead of pushing it out on its own.
+	 * The last batch of a burst goes out without the flag.
+	 */
+	if (s)
+		flags |= MSG_MORE;
+#endif
+
 	do {
-		num = writev(connection->fd, iov, iovsz);
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovsz;
+		num = sendmsg(connection->fd, &msg, flags);
+		atomic_fetch_add_explicit(&peer->write_calls, 1,
+					  memory_order_relaxed);
 
 		if (num < 0) {
 			if (!ERRNO_IO_RETRY(errno)) {
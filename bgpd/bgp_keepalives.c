@@ -14,6 +14,7 @@
 #include "log.h"		// for zlog_debug
 #include "memory.h"		// for MTYPE_TMP, XFREE, XCALLOC, XMALLOC
 #include "monotime.h"		// for monotime, monotime_since
+#include "typesafe.h"		// for PREDECL_HEAP, DECLARE_HEAP
 
 #include "bgpd/bgpd.h"          // for peer, PEER_EVENT_KEEPALIVES_ON, peer...
 #include "bgpd/bgp_debug.h"	// for bgp_debug_neighbor_events
@@ -25,6 +26,8 @@ DEFINE_MTYPE_STATIC(BGPD, BGP_PKAT, "Peer KeepAlive Timer");
 DEFINE_MTYPE_STATIC(BGPD, BGP_COND, "BGP Peer pthread Conditional");
 DEFINE_MTYPE_STATIC(BGPD, BGP_MUTEX, "BGP Peer pthread Mutex");
 
+PREDECL_HEAP(pkat_heap);
+
 /*
  * Peer KeepAlive Timer.
  * Associates a peer with the time of its last keepalive.
@@ -34,18 +37,55 @@ struct pkat {
 	struct peer *peer;
 	/* absolute time of last keepalive sent */
 	struct timeval last;
+	/* absolute time this peer has to be looked at again */
+	struct timeval next;
+	/* entry in pkat_heap, ordered by next */
+	struct pkat_heap_item heapitem;
 };
 
-/* List of peers we are sending keepalives for, and associated mutex. */
+static int pkat_cmp(const struct pkat *a, const struct pkat *b)
+{
+	if (timercmp(&a->next, &b->next, <))
+		return -1;
+	if (timercmp(&a->next, &b->next, >))
+		return 1;
+	return 0;
+}
+
+DECLARE_HEAP(pkat_heap, struct pkat, heapitem, pkat_cmp);
+
+/*
+ * Peers we are sending keepalives for, and associated mutex.  The hash is
+ * only used to find a peer's entry; the heap orders the same entries by
+ * when they are next due, so that a tick only touches the peers that need
+ * a keepalive rather than every established session.
+ */
 static pthread_mutex_t *peerhash_mtx;
 static pthread_cond_t *peerhash_cond;
 static struct hash *peerhash;
+static struct pkat_heap_head pkat_heap[1];
+
+/* Time until an entry with a 0 keepalive timer is looked at again. */
+static const struct timeval pkat_idle = {1, 0};
+
+static void pkat_schedule(struct pkat *pkat)
+{
+	struct timeval ka = {0};
+
+	ka.tv_sec = atomic_load_explicit(&pkat->peer->v_keepalive,
+					 memory_order_relaxed);
+	if (ka.tv_sec == 0)
+		ka = pkat_idle;
+
+	timeradd(&pkat->last, &ka, &pkat->next);
+}
 
 static struct pkat *pkat_new(struct peer *peer)
 {
-	struct pkat *pkat = XMALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+	struct pkat *pkat = XCALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
 	pkat->peer = peer;
 	monotime(&pkat->last);
+	pkat_schedule(pkat);
 	return pkat;
 }
 
@@ -56,67 +96,68 @@ static void pkat_del(void *pkat)
 
 
 /*
- * Callback for hash_iterate. Determines if a peer needs a keepalive and if so,
- * generates and sends it.
+ * Sends keepalives to the peers which are due for one.
  *
- * For any given peer, if the elapsed time since its last keepalive exceeds its
- * configured keepalive timer, a keepalive is sent to the peer and its
- * last-sent time is reset. Additionally, If the elapsed time does not exceed
- * the configured keepalive timer, but the time until the next keepalive is due
- * is within a hardcoded tolerance, a keepalive is sent as if the configured
- * timer was exceeded. Doing this helps alleviate nanosecond sleeps between
- * ticks by grouping together peers who are due for keepalives at roughly the
- * same time. This tolerance value is arbitrarily chosen to be 100ms.
+ * A peer is due once the elapsed time since its last keepalive reaches its
+ * configured keepalive timer. Additionally, if the time until the next
+ * keepalive is due is within a hardcoded tolerance, a keepalive is sent as
+ * if the configured timer was exceeded. Doing this helps alleviate
+ * nanosecond sleeps between ticks by grouping together peers who are due for
+ * keepalives at roughly the same time. This tolerance value is arbitrarily
+ * chosen to be 100ms.
  *
- * In addition, this function calculates the maximum amount of time that the
- * keepalive thread can sleep before another tick needs to take place. This is
- * equivalent to shortest time until a keepalive is due for any one peer.
+ * Peers are kept in a heap ordered by when they are next due, so only the
+ * peers sent a keepalive are looked at, and the heap's first entry tells how
+ * long the keepalive thread can sleep before another tick needs to take
+ * place.
  *
- * @return maximum time to wait until next update (0 if infinity)
+ * @param next_update maximum time to wait until next update, tv_sec is -1
+ *        if there are no peers
  */
-static void peer_process(struct hash_bucket *hb, void *arg)
+static void peer_process(struct timeval *next_update)
 {
-	struct pkat *pkat = hb->data;
-
-	struct timeval *next_update = arg;
-
-	static struct timeval elapsed;  // elapsed time since keepalive
-	static struct timeval ka = {0}; // peer->v_keepalive as a timeval
-	static struct timeval diff;     // ka - elapsed
-
 	static const struct timeval tolerance = {0, 100000};
 
-	uint32_t v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
-					     memory_order_relaxed);
+	struct timeval now, limit;
+	struct pkat *pkat;
+	uint32_t v_ka;
 
-	/* 0 keepalive timer means no keepalives */
-	if (v_ka == 0)
-		return;
+	monotime(&now);
+	timeradd(&now, &tolerance, &limit);
 
-	/* calculate elapsed time since last keepalive */
-	monotime_since(&pkat->last, &elapsed);
+	while ((pkat = pkat_heap_first(pkat_heap)) &&
+	       timercmp(&pkat->next, &limit, <)) {
+		pkat_heap_pop(pkat_heap);
 
-	/* calculate difference between elapsed time and configured time */
-	ka.tv_sec = v_ka;
-	timersub(&ka, &elapsed, &diff);
+		v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
+					    memory_order_relaxed);
 
-	int send_keepalive =
-		elapsed.tv_sec >= ka.tv_sec || timercmp(&diff, &tolerance, <);
+		/* 0 keepalive timer means no keepalives */
+		if (v_ka == 0) {
+			timeradd(&now, &pkat_idle, &pkat->next);
+			pkat_heap_add(pkat_heap, pkat);
+			continue;
+		}
 
-	if (send_keepalive) {
-		if (bgp_debug_keepalive(pkat->peer))
-			zlog_debug("%s [FSM] Timer (keepalive timer expire)",
-				   pkat->peer->host);
+		/* the keepalive timer may have changed since we queued it */
+		pkat_schedule(pkat);
+		if (timercmp(&pkat->next, &limit, <)) {
+			if (bgp_debug_keepalive(pkat->peer))
+				zlog_debug("%s [FSM] Timer (keepalive timer expire)",
+					   pkat->peer->host);
 
-		bgp_keepalive_send(pkat->peer);
-		monotime(&pkat->last);
-		memset(&elapsed, 0, sizeof(elapsed));
-		diff = ka;
+			bgp_keepalive_send(pkat->peer);
+			pkat->last = now;
+			pkat_schedule(pkat);
+		}
+
+		pkat_heap_add(pkat_heap, pkat);
 	}
 
-	/* if calculated next update for this peer < current delay, use it */
-	if (next_update->tv_sec < 0 || timercmp(&diff, next_update, <))
-		*next_update = diff;
+	if (pkat)
+		timersub(&pkat->next, &now, next_update);
+	else
+		next_update->tv_sec = -1;
 }
 
 static bool peer_hash_cmp(const void *f, const void *s)
@@ -136,6 +177,9 @@ static unsigned int peer_hash_key(const void *arg)
 /* Cleanup handler / deinitializer. */
 static void bgp_keepalives_finish(void *arg)
 {
+	while (pkat_heap_pop(pkat_heap))
+		;
+	pkat_heap_fini(pkat_heap);
 	hash_clean_and_free(&peerhash, pkat_del);
 
 	pthread_mutex_unlock(peerhash_mtx);
@@ -189,6 +233,7 @@ void *bgp_keepalives_start(void *arg)
 
 	/* initialize peer hashtable */
 	peerhash = hash_create_size(2048, peer_hash_key, peer_hash_cmp, NULL);
+	pkat_heap_init(pkat_heap);
 	pthread_mutex_lock(peerhash_mtx);
 
 	/* register cleanup handler */
@@ -209,9 +254,7 @@ void *bgp_keepalives_start(void *arg)
 
 		monotime(&currtime);
 
-		next_update.tv_sec = -1;
-
-		hash_iterate(peerhash, peer_process, &next_update);
+		peer_process(&next_update);
 		if (next_update.tv_sec == -1)
 			memset(&next_update, 0, sizeof(next_update));
 
@@ -252,6 +295,7 @@ void bgp_keepalives_on(struct peer_connection *connection)
 		if (!hash_lookup(peerhash, &holder)) {
 			struct pkat *pkat = pkat_new(peer);
 			(void)hash_get(peerhash, pkat, hash_alloc_intern);
+			pkat_heap_add(pkat_heap, pkat);
 			peer_lock(peer);
 		}
 		SET_FLAG(peer->thread_flags, PEER_THREAD_KEEPALIVES_ON);
@@ -282,6 +326,7 @@ void bgp_keepalives_off(struct peer_connection *connection)
 		holder.peer = peer;
 		struct pkat *res = hash_release(peerhash, &holder);
 		if (res) {
+			pkat_heap_del(pkat_heap, res);
 			pkat_del(res);
 			peer_unlock(peer);
 		}
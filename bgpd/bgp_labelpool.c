@@ -86,6 +86,7 @@ struct lp_lcb {
 struct lp_fifo {
 	struct lp_fifo_item fifo;
 	struct lp_lcb	lcb;
+	struct timeval	queued;		/* when request was blocked */
 };
 
 DECLARE_LIST(lp_fifo, struct lp_fifo, fifo);
@@ -257,6 +258,25 @@ void bgp_lp_finish(void)
 	lp = NULL;
 }
 
+static void lp_requests_update_max(void)
+{
+	size_t count = lp_fifo_count(&lp->requests);
+
+	if (count > lp->requests_max)
+		lp->requests_max = count;
+}
+
+/* account for time spent by a request blocked on zebra */
+static void lp_requests_wait_done(struct lp_fifo *lf)
+{
+	uint64_t waited = monotime_since(&lf->queued, NULL);
+
+	lp->wait_count++;
+	lp->wait_total += waited;
+	if (waited > lp->wait_max)
+		lp->wait_max = waited;
+}
+
 static mpls_label_t get_label_from_pool(void *labelid)
 {
 	struct listnode *node;
@@ -441,10 +461,12 @@ void bgp_lp_get(
 		sizeof(struct lp_fifo));
 
 	lf->lcb = *lcb;
+	monotime(&lf->queued);
 	/* if this is a LU request, lock node before queueing */
 	check_bgp_lu_cb_lock(lcb);
 
 	lp_fifo_add_tail(&lp->requests, lf);
+	lp_requests_update_max();
 
 	if (lp_fifo_count(&lp->requests) > lp->pending_count) {
 		if (!bgp_zebra_request_label_range(MPLS_LABEL_BASE_ANY,
@@ -497,9 +519,17 @@ void bgp_lp_release(
 				break;
 			}
 			assert(deallocated);
+			/*
+			 * Hand a chunk back to zebra once it is entirely
+			 * free, but hold on to the last one: with label
+			 * churn (e.g., routes flapping during a peer
+			 * restart) releasing it would just cost another
+			 * chunk request on the next allocation.
+			 */
 			if (deallocated &&
 			    chunk->nfree == chunk->last - chunk->first + 1 &&
-			    lp_fifo_count(&lp->requests) == 0) {
+			    lp_fifo_count(&lp->requests) == 0 &&
+			    listcount(lp->chunks) > 1) {
 				bgp_zebra_release_label_range(chunk->first,
 							      chunk->last);
 				list_delete_node(lp->chunks, node);
@@ -515,7 +545,7 @@ static void bgp_sync_label_manager(struct event *e)
 	int debug = BGP_DEBUG(labelpool, LABELPOOL);
 	struct lp_fifo *lf;
 
-	while ((lf = lp_fifo_pop(&lp->requests))) {
+	while ((lf = lp_fifo_first(&lp->requests))) {
 		struct lp_lcb *lcb;
 		void *labelid = lf->lcb.labelid;
 
@@ -528,7 +558,7 @@ static void bgp_sync_label_manager(struct event *e)
 			}
 			/* if this was a BGP_LU request, unlock node
 			 */
-			check_bgp_lu_cb_unlock(lcb);
+			check_bgp_lu_cb_unlock(&lf->lcb);
 			goto finishedrequest;
 		}
 
@@ -560,6 +590,8 @@ static void bgp_sync_label_manager(struct event *e)
 			break;
 		}
 
+		lp_requests_wait_done(lf);
+
 		/*
 		 * we filled the request from local pool.
 		 * Enqueue response work item with new label.
@@ -580,6 +612,7 @@ static void bgp_sync_label_manager(struct event *e)
 		work_queue_add(lp->callback_q, q);
 
 finishedrequest:
+		lp_fifo_del(&lp->requests, lf);
 		XFREE(MTYPE_BGP_LABEL_FIFO, lf);
 	}
 
@@ -615,6 +648,16 @@ void bgp_lp_event_chunk(uint32_t first, uint32_t last)
 	listnode_add_head(lp->chunks, chunk);
 
 	lp->pending_count -= labelcount;
+
+	/*
+	 * Hand out the new labels to blocked requests right away rather
+	 * than leaving them for the next periodic sync.
+	 */
+	if (lp_fifo_count(&lp->requests)) {
+		EVENT_OFF(bm->t_bgp_sync_label_manager);
+		event_add_event(bm->master, bgp_sync_label_manager, NULL, 0,
+				&bm->t_bgp_sync_label_manager);
+	}
 }
 
 /*
@@ -701,8 +744,10 @@ void bgp_lp_event_zebra_up(void)
 				sizeof(struct lp_fifo));
 
 			lf->lcb = *lcb;
+			monotime(&lf->queued);
 			check_bgp_lu_cb_lock(lcb);
 			lp_fifo_add_tail(&lp->requests, lf);
+			lp_requests_update_max();
 		}
 
 		skiplist_delete_first(lp->inuse);
@@ -720,6 +765,7 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
 {
 	bool uj = use_json(argc, argv);
 	json_object *json = NULL;
+	uint64_t wait_avg;
 
 	if (!lp) {
 		if (uj)
@@ -729,6 +775,8 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
 		return (CMD_WARNING);
 	}
 
+	wait_avg = lp->wait_count ? lp->wait_total / lp->wait_count : 0;
+
 	if (uj) {
 		json = json_object_new_object();
 		json_object_int_add(json, "ledger", skiplist_count(lp->ledger));
@@ -738,6 +786,12 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
 		json_object_int_add(json, "labelChunks", listcount(lp->chunks));
 		json_object_int_add(json, "pending", lp->pending_count);
 		json_object_int_add(json, "reconnects", lp->reconnect_count);
+		json_object_int_add(json, "requestsMax", lp->requests_max);
+		json_object_int_add(json, "callbackQueue",
+				    work_queue_item_count(lp->callback_q));
+		json_object_int_add(json, "requestWaits", lp->wait_count);
+		json_object_int_add(json, "requestWaitAvgUsec", wait_avg);
+		json_object_int_add(json, "requestWaitMaxUsec", lp->wait_max);
 		vty_json(vty, json);
 	} else {
 		vty_out(vty, "Labelpool Summary\n");
@@ -751,6 +805,12 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
 			"LabelChunks:", listcount(lp->chunks));
 		vty_out(vty, "%-13s %d\n", "Pending:", lp->pending_count);
 		vty_out(vty, "%-13s %d\n", "Reconnects:", lp->reconnect_count);
+		vty_out(vty, "%-13s %zu\n", "RequestsMax:", lp->requests_max);
+		vty_out(vty, "%-13s %d\n", "CallbackQ:",
+			work_queue_item_count(lp->callback_q));
+		vty_out(vty, "%-13s %" PRIu64 " (avg %" PRIu64
+			     " usec, max %" PRIu64 " usec)\n",
+			"RequestWaits:", lp->wait_count, wait_avg, lp->wait_max);
 	}
 	return CMD_SUCCESS;
 }
@@ -31,6 +31,12 @@ struct labelpool {
 	uint32_t		pending_count;	/* requested from zebra */
 	uint32_t reconnect_count;		/* zebra reconnections */
 	uint32_t next_chunksize;		/* request this many labels */
+
+	/* instrumentation */
+	size_t requests_max;			/* requests high-water mark */
+	uint64_t wait_count;			/* requests filled after wait */
+	uint64_t wait_total;			/* usec waited, all requests */
+	uint64_t wait_max;			/* usec waited, worst request */
 };
 
 extern void bgp_lp_init(struct event_loop *master, struct labelpool *pool);
@@ -562,9 +562,31 @@ void bgp_aggr_lcommunity_remove(void *arg)
 void bgp_compute_aggregate_lcommunity(struct bgp_aggregate *aggregate,
 				      struct lcommunity *lcommunity)
 {
+	struct lcommunity *aggr_lcommunity = NULL;
+	struct lcommunity *lcommerge;
+
+	if ((aggregate == NULL) || (lcommunity == NULL))
+		return;
+
+	if (aggregate->lcommunity_hash)
+		aggr_lcommunity = bgp_aggr_lcommunity_lookup(aggregate,
+							     lcommunity);
 
 	bgp_compute_aggregate_lcommunity_hash(aggregate, lcommunity);
-	bgp_compute_aggregate_lcommunity_val(aggregate);
+
+	/* Already contributed, the aggregate's lcommunity is unchanged.
+	 */
+	if (aggr_lcommunity)
+		return;
+
+	/* Merge just the new lcommunity into the aggregate's.
+	 */
+	if (aggregate->lcommunity) {
+		lcommerge = lcommunity_merge(aggregate->lcommunity, lcommunity);
+		aggregate->lcommunity = lcommunity_uniq_sort(lcommerge);
+		lcommunity_free(&lcommerge);
+	} else
+		aggregate->lcommunity = lcommunity_uniq_sort(lcommunity);
 }
 
 void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
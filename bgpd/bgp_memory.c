@@ -28,6 +28,7 @@ DEFINE_MTYPE(BGPD, PEER_PASSWORD, "Peer password string");
 DEFINE_MTYPE(BGPD, BGP_PEER_AF, "BGP peer af");
 DEFINE_MTYPE(BGPD, BGP_UPDGRP, "BGP update group");
 DEFINE_MTYPE(BGPD, BGP_UPD_SUBGRP, "BGP update subgroup");
+DEFINE_MTYPE(BGPD, BGP_UPD_WALK, "BGP update group table walk");
 DEFINE_MTYPE(BGPD, BGP_PACKET, "BGP packet");
 DEFINE_MTYPE(BGPD, ATTR, "BGP attribute");
 DEFINE_MTYPE(BGPD, AS_PATH, "BGP aspath");
@@ -24,6 +24,7 @@ DECLARE_MTYPE(PEER_PASSWORD);
 DECLARE_MTYPE(BGP_PEER_AF);
 DECLARE_MTYPE(BGP_UPDGRP);
 DECLARE_MTYPE(BGP_UPD_SUBGRP);
+DECLARE_MTYPE(BGP_UPD_WALK);
 DECLARE_MTYPE(BGP_PACKET);
 DECLARE_MTYPE(ATTR);
 DECLARE_MTYPE(AS_PATH);
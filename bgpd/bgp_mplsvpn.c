@@ -15,6 +15,8 @@
 #include "mpls.h"
 #include "json.h"
 #include "zclient.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_debug.h"
@@ -41,6 +43,7 @@
 
 DEFINE_MTYPE_STATIC(BGPD, MPLSVPN_NH_LABEL_BIND_CACHE,
 		    "BGP MPLSVPN nexthop label bind cache");
+DEFINE_MTYPE_STATIC(BGPD, MPLSVPN_RT_IMPORT, "BGP MPLSVPN RT import index");
 
 /*
  * Definitions and external declarations.
@@ -2024,6 +2027,173 @@ void vpn_leak_from_vrf_update_all(struct bgp *to_bgp, struct bgp *from_bgp,
 	}
 }
 
+/*
+ * Instances importing from VPN, indexed by the route targets of their
+ * import rtlist.  Leaking a VPN path then only visits the instances that
+ * share one of its route targets instead of every instance.  The index is
+ * dropped whenever an import rtlist or the set of instances changes, and
+ * rebuilt on next use.
+ */
+struct vpn_rt_import {
+	afi_t afi;
+	uint8_t val[ECOMMUNITY_SIZE];
+
+	/* struct bgp * importing this route target */
+	struct list *bgps;
+};
+
+static struct hash *vpn_rt_import_hash;
+
+/* Instances whose import rtlist is not made of plain ECOMMUNITY_SIZE
+ * route targets; these are always visited.
+ */
+static struct list *vpn_rt_import_unindexed[AFI_MAX];
+
+static uint32_t vpn_rt_import_walk_id;
+
+static unsigned int vpn_rt_import_hash_key(const void *arg)
+{
+	const struct vpn_rt_import *rti = arg;
+
+	return jhash(rti->val, ECOMMUNITY_SIZE, rti->afi);
+}
+
+static bool vpn_rt_import_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct vpn_rt_import *rti1 = arg1;
+	const struct vpn_rt_import *rti2 = arg2;
+
+	return rti1->afi == rti2->afi &&
+	       !memcmp(rti1->val, rti2->val, ECOMMUNITY_SIZE);
+}
+
+static void *vpn_rt_import_alloc(void *arg)
+{
+	const struct vpn_rt_import *key = arg;
+	struct vpn_rt_import *rti;
+
+	rti = XCALLOC(MTYPE_MPLSVPN_RT_IMPORT, sizeof(*rti));
+	rti->afi = key->afi;
+	memcpy(rti->val, key->val, ECOMMUNITY_SIZE);
+	rti->bgps = list_new();
+
+	return rti;
+}
+
+static void vpn_rt_import_free(void *arg)
+{
+	struct vpn_rt_import *rti = arg;
+
+	list_delete(&rti->bgps);
+	XFREE(MTYPE_MPLSVPN_RT_IMPORT, rti);
+}
+
+static void vpn_rt_import_build(void)
+{
+	struct listnode *node;
+	struct bgp *bgp;
+	struct ecommunity *ecom;
+	struct vpn_rt_import key = {};
+	struct vpn_rt_import *rti;
+	afi_t afi;
+	uint32_t i;
+
+	vpn_rt_import_hash = hash_create(vpn_rt_import_hash_key,
+					 vpn_rt_import_hash_cmp,
+					 "BGP VPN RT import index");
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		vpn_rt_import_unindexed[afi] = list_new();
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+			ecom = bgp->vpn_policy[afi]
+				       .rtlist[BGP_VPN_POLICY_DIR_FROMVPN];
+			if (!ecom)
+				continue;
+
+			if (ecom->unit_size != ECOMMUNITY_SIZE) {
+				listnode_add(vpn_rt_import_unindexed[afi], bgp);
+				continue;
+			}
+
+			key.afi = afi;
+			for (i = 0; i < ecom->size; i++) {
+				memcpy(key.val,
+				       ecom->val + (i * ECOMMUNITY_SIZE),
+				       ECOMMUNITY_SIZE);
+				rti = hash_get(vpn_rt_import_hash, &key,
+					       vpn_rt_import_alloc);
+				listnode_add(rti->bgps, bgp);
+			}
+		}
+	}
+}
+
+void vpn_leak_rt_import_invalidate(void)
+{
+	afi_t afi;
+
+	if (!vpn_rt_import_hash)
+		return;
+
+	hash_clean_and_free(&vpn_rt_import_hash, vpn_rt_import_free);
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		list_delete(&vpn_rt_import_unindexed[afi]);
+}
+
+/*
+ * Call func once for every instance whose import rtlist may intersect
+ * ecom, until it returns false.  Instances are filtered on route targets
+ * only; func still has to check whether the instance imports at all.
+ */
+static void vpn_rt_import_foreach(afi_t afi, struct ecommunity *ecom,
+				  bool (*func)(struct bgp *bgp, void *arg),
+				  void *arg)
+{
+	struct vpn_rt_import key = {};
+	struct vpn_rt_import *rti;
+	struct listnode *node;
+	struct bgp *bgp;
+	uint32_t walk;
+	uint32_t i;
+
+	if (!ecom)
+		return;
+
+	if (!vpn_rt_import_hash)
+		vpn_rt_import_build();
+
+	walk = ++vpn_rt_import_walk_id;
+	if (!walk)
+		walk = ++vpn_rt_import_walk_id;
+
+	for (ALL_LIST_ELEMENTS_RO(vpn_rt_import_unindexed[afi], node, bgp)) {
+		bgp->vpn_policy[afi].rt_import_walk = walk;
+		if (!func(bgp, arg))
+			return;
+	}
+
+	if (ecom->unit_size != ECOMMUNITY_SIZE)
+		return;
+
+	key.afi = afi;
+	for (i = 0; i < ecom->size; i++) {
+		memcpy(key.val, ecom->val + (i * ECOMMUNITY_SIZE),
+		       ECOMMUNITY_SIZE);
+		rti = hash_lookup(vpn_rt_import_hash, &key);
+		if (!rti)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(rti->bgps, node, bgp)) {
+			if (bgp->vpn_policy[afi].rt_import_walk == walk)
+				continue;
+			bgp->vpn_policy[afi].rt_import_walk = walk;
+			if (!func(bgp, arg))
+				return;
+		}
+	}
+}
+
 static struct bgp *bgp_lookup_by_rd(struct bgp_path_info *bpi,
 				    struct prefix_rd *rd, afi_t afi)
 {
@@ -2304,43 +2474,67 @@ static void vpn_leak_to_vrf_update_onevrf(struct bgp *to_bgp,   /* to */
 		bgp_dest_unlock_node(bn);
 }
 
-bool vpn_leak_to_vrf_no_retain_filter_check(struct bgp *from_bgp,
-					    struct attr *attr, afi_t afi)
+struct vpn_leak_to_vrf_arg {
+	struct bgp *from_bgp;
+	struct bgp_path_info *path_vpn;
+	struct prefix_rd *prd;
+	struct ecommunity *ecom;
+	afi_t afi;
+	bool imported;
+};
+
+static bool vpn_leak_to_vrf_no_retain_filter_cb(struct bgp *to_bgp,
+						void *arg)
 {
-	struct ecommunity *ecom_route_target = bgp_attr_get_ecommunity(attr);
+	struct vpn_leak_to_vrf_arg *la = arg;
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
-	struct listnode *node;
 	const char *debugmsg;
-	struct bgp *to_bgp;
 
-	/* Loop over BGP instances */
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, to_bgp)) {
-		if (!vpn_leak_from_vpn_active(to_bgp, afi, &debugmsg)) {
-			if (debug)
-				zlog_debug(
-					"%s: from vpn (%s) to vrf (%s) afi %s, skipping: %s",
-					__func__, from_bgp->name_pretty,
-					to_bgp->name_pretty, afi2str(afi),
-					debugmsg);
-			continue;
-		}
+	if (!vpn_leak_from_vpn_active(to_bgp, la->afi, &debugmsg)) {
+		if (debug)
+			zlog_debug(
+				"%s: from vpn (%s) to vrf (%s) afi %s, skipping: %s",
+				__func__, la->from_bgp->name_pretty,
+				to_bgp->name_pretty, afi2str(la->afi),
+				debugmsg);
+		return true;
+	}
 
-		/* Check for intersection of route targets */
-		if (!ecommunity_include(
-			    to_bgp->vpn_policy[afi]
-				    .rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
-			    ecom_route_target)) {
-			if (debug)
-				zlog_debug(
-					"%s: from vpn (%s) to vrf (%s) afi %s %s, skipping after no intersection of route targets",
-					__func__, from_bgp->name_pretty,
-					to_bgp->name_pretty, afi2str(afi),
-					ecommunity_str(ecom_route_target));
-			continue;
-		}
-		return false;
+	/* Check for intersection of route targets */
+	if (!ecommunity_include(
+		    to_bgp->vpn_policy[la->afi]
+			    .rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
+		    la->ecom)) {
+		if (debug)
+			zlog_debug(
+				"%s: from vpn (%s) to vrf (%s) afi %s %s, skipping after no intersection of route targets",
+				__func__, la->from_bgp->name_pretty,
+				to_bgp->name_pretty, afi2str(la->afi),
+				ecommunity_str(la->ecom));
+		return true;
 	}
 
+	la->imported = true;
+	return false;
+}
+
+bool vpn_leak_to_vrf_no_retain_filter_check(struct bgp *from_bgp,
+					    struct attr *attr, afi_t afi)
+{
+	struct ecommunity *ecom_route_target = bgp_attr_get_ecommunity(attr);
+	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
+	struct vpn_leak_to_vrf_arg la = {
+		.from_bgp = from_bgp,
+		.ecom = ecom_route_target,
+		.afi = afi,
+	};
+
+	/* Loop over BGP instances sharing a route target */
+	vpn_rt_import_foreach(afi, ecom_route_target,
+			      vpn_leak_to_vrf_no_retain_filter_cb, &la);
+	if (la.imported)
+		return false;
+
 	if (debug)
 		zlog_debug(
 			"%s: from vpn (%s) afi %s %s, no import - must be filtered",
@@ -2350,41 +2544,101 @@ bool vpn_leak_to_vrf_no_retain_filter_check(struct bgp *from_bgp,
 	return true;
 }
 
+static bool vpn_leak_to_vrf_update_cb(struct bgp *bgp, void *arg)
+{
+	struct vpn_leak_to_vrf_arg *la = arg;
+	struct bgp_path_info *path_vpn = la->path_vpn;
+
+	if (!path_vpn->extra || !path_vpn->extra->vrfleak ||
+	    path_vpn->extra->vrfleak->bgp_orig != bgp) /* no loop */
+		vpn_leak_to_vrf_update_onevrf(bgp, la->from_bgp, path_vpn,
+					      la->prd);
+	return true;
+}
+
 void vpn_leak_to_vrf_update(struct bgp *from_bgp,
 			    struct bgp_path_info *path_vpn,
 			    struct prefix_rd *prd)
 {
-	struct listnode *mnode, *mnnode;
-	struct bgp *bgp;
+	const struct prefix *p = bgp_dest_get_prefix(path_vpn->net);
+	struct vpn_leak_to_vrf_arg la = {
+		.from_bgp = from_bgp,
+		.path_vpn = path_vpn,
+		.prd = prd,
+	};
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
 	if (debug)
 		zlog_debug("%s: start (path_vpn=%p)", __func__, path_vpn);
 
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
-		if (!path_vpn->extra || !path_vpn->extra->vrfleak ||
-		    path_vpn->extra->vrfleak->bgp_orig != bgp) { /* no loop */
-			vpn_leak_to_vrf_update_onevrf(bgp, from_bgp, path_vpn,
-						      prd);
-		}
-	}
+	/* Loop over VRFs sharing a route target */
+	vpn_rt_import_foreach(family2afi(p->family),
+			      bgp_attr_get_ecommunity(path_vpn->attr),
+			      vpn_leak_to_vrf_update_cb, &la);
 }
 
-void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn)
+static bool vpn_leak_to_vrf_withdraw_cb(struct bgp *bgp, void *arg)
 {
-	const struct prefix *p;
-	afi_t afi;
+	struct vpn_leak_to_vrf_arg *la = arg;
+	struct bgp_path_info *path_vpn = la->path_vpn;
+	const struct prefix *p = bgp_dest_get_prefix(path_vpn->net);
+	afi_t afi = la->afi;
 	safi_t safi = SAFI_UNICAST;
-	struct bgp *bgp;
-	struct listnode *mnode, *mnnode;
 	struct bgp_dest *bn;
 	struct bgp_path_info *bpi;
 	const char *debugmsg;
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
+	if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
+		if (debug)
+			zlog_debug("%s: from %s, skipping: %s", __func__,
+				   bgp->name_pretty, debugmsg);
+		return true;
+	}
+
+	/* Check for intersection of route targets */
+	if (!ecommunity_include(
+		    bgp->vpn_policy[afi].rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
+		    bgp_attr_get_ecommunity(path_vpn->attr)))
+		return true;
+
+	if (debug)
+		zlog_debug("%s: withdrawing from vrf %s", __func__,
+			   bgp->name_pretty);
+
+	bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
+
+	for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next) {
+		if (bpi->extra && bpi->extra->vrfleak &&
+		    (struct bgp_path_info *)bpi->extra->vrfleak->parent ==
+			    path_vpn) {
+			break;
+		}
+	}
+
+	if (bpi) {
+		if (debug)
+			zlog_debug("%s: deleting bpi %p", __func__, bpi);
+		bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
+		bgp_path_info_delete(bn, bpi);
+		bgp_process(bgp, bn, afi, safi);
+	}
+	bgp_dest_unlock_node(bn);
+
+	return true;
+}
+
+void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn)
+{
+	const struct prefix *p;
+	struct vpn_leak_to_vrf_arg la = {
+		.path_vpn = path_vpn,
+	};
+
+	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
+
 	if (debug)
 		zlog_debug("%s: entry: p=%pBD, type=%d, sub_type=%d", __func__,
 			   path_vpn->net, path_vpn->type, path_vpn->sub_type);
@@ -2409,52 +2663,11 @@ void vpn_leak_to_vrf_withdraw(struct bgp_path_info *path_vpn)
 	}
 
 	p = bgp_dest_get_prefix(path_vpn->net);
-	afi = family2afi(p->family);
-
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
-		if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
-			if (debug)
-				zlog_debug("%s: from %s, skipping: %s",
-					   __func__, bgp->name_pretty,
-					   debugmsg);
-			continue;
-		}
-
-		/* Check for intersection of route targets */
-		if (!ecommunity_include(
-			    bgp->vpn_policy[afi]
-				    .rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
-			    bgp_attr_get_ecommunity(path_vpn->attr))) {
-
-			continue;
-		}
-
-		if (debug)
-			zlog_debug("%s: withdrawing from vrf %s", __func__,
-				   bgp->name_pretty);
-
-		bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
+	la.afi = family2afi(p->family);
 
-		for (bpi = bgp_dest_get_bgp_path_info(bn); bpi;
-		     bpi = bpi->next) {
-			if (bpi->extra && bpi->extra->vrfleak &&
-			    (struct bgp_path_info *)bpi->extra->vrfleak->parent ==
-				    path_vpn) {
-				break;
-			}
-		}
-
-		if (bpi) {
-			if (debug)
-				zlog_debug("%s: deleting bpi %p", __func__,
-					   bpi);
-			bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
-			bgp_path_info_delete(bn, bpi);
-			bgp_process(bgp, bn, afi, safi);
-		}
-		bgp_dest_unlock_node(bn);
-	}
+	/* Loop over VRFs sharing a route target */
+	vpn_rt_import_foreach(la.afi, bgp_attr_get_ecommunity(path_vpn->attr),
+			      vpn_leak_to_vrf_withdraw_cb, &la);
 }
 
 void vpn_leak_to_vrf_withdraw_all(struct bgp *to_bgp, afi_t afi)
@@ -2707,6 +2920,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 						.rtlist[idir],
 					(struct ecommunity_val *)ecom->val);
 			}
+			vpn_leak_rt_import_invalidate();
 		} else {
 			/* New router-id derive auto RD and RT and export
 			 * to VPN
@@ -2745,6 +2959,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 					bgp_import->vpn_policy[afi].rtlist[idir]
 						= ecommunity_dup(ecom);
 			}
+			vpn_leak_rt_import_invalidate();
 
 			/* Update routes to VPN */
 			vpn_leak_postchange(BGP_VPN_POLICY_DIR_TOVPN,
@@ -2866,6 +3081,7 @@ void vrf_import_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 					 .rtlist[idir], ecom);
 	else
 		to_bgp->vpn_policy[afi].rtlist[idir] = ecommunity_dup(ecom);
+	vpn_leak_rt_import_invalidate();
 	SET_FLAG(to_bgp->af_flags[afi][safi], BGP_CONFIG_VRF_TO_VRF_IMPORT);
 
 	if (debug) {
@@ -2956,11 +3172,13 @@ void vrf_unimport_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 				   BGP_CONFIG_VRF_TO_VRF_IMPORT);
 		if (to_bgp->vpn_policy[afi].rtlist[idir])
 			ecommunity_free(&to_bgp->vpn_policy[afi].rtlist[idir]);
+		vpn_leak_rt_import_invalidate();
 	} else {
 		ecom = from_bgp->vpn_policy[afi].rtlist[edir];
 		if (ecom)
 			ecommunity_del_val(to_bgp->vpn_policy[afi].rtlist[idir],
 				   (struct ecommunity_val *)ecom->val);
+		vpn_leak_rt_import_invalidate();
 		vpn_leak_postchange(idir, afi, bgp_get_default(), to_bgp);
 	}
 
@@ -3899,6 +4117,7 @@ void bgp_vpn_leak_export(struct bgp *from_bgp)
 						to_vpolicy->rtlist[idir],
 						(struct ecommunity_val *)
 							ecom->val);
+				vpn_leak_rt_import_invalidate();
 				vrf_import_from_vrf(to_bgp, from_bgp,
 						    afi, safi);
 				break;
@@ -427,7 +427,8 @@ static void bgp_write_proceed_actions(struct peer *peer)
 
 		/* No packets to send, see if EOR is pending */
 		if (CHECK_FLAG(peer->cap, PEER_CAP_RESTART_RCV)) {
-			if (!subgrp->t_coalesce && peer->afc_nego[afi][safi]
+			if (!subgrp->t_coalesce && !subgrp->walk
+			    && peer->afc_nego[afi][safi]
 			    && peer->synctime
 			    && !CHECK_FLAG(peer->af_sflags[afi][safi],
 					   PEER_STATUS_EOR_SEND)
@@ -562,6 +563,7 @@ void bgp_generate_updgrp_packets(struct event *thread)
 				if (CHECK_FLAG(peer->cap,
 					       PEER_CAP_RESTART_RCV)) {
 					if (!(PAF_SUBGRP(paf))->t_coalesce
+					    && !(PAF_SUBGRP(paf))->walk
 					    && peer->afc_nego[afi][safi]
 					    && peer->synctime
 					    && !CHECK_FLAG(
@@ -1173,12 +1173,8 @@ int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 	}
 
 	/* 8. IGP metric check. */
-	newm = existm = 0;
-
-	if (new->extra)
-		newm = new->extra->igpmetric;
-	if (exist->extra)
-		existm = exist->extra->igpmetric;
+	newm = new->igpmetric;
+	existm = exist->igpmetric;
 
 	if (newm < existm) {
 		if (debug && peer_sort_ret < 0)
@@ -3386,8 +3382,9 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 					|| new_select->sub_type
 						   == BGP_ROUTE_IMPORTED))
 
-					bgp_zebra_announce(dest, p, old_select,
-							   bgp, afi, safi);
+					bgp_zebra_route_install(dest,
+								old_select,
+								bgp, true);
 			}
 		}
 
@@ -3506,7 +3503,7 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 			    is_route_parent_evpn(old_select))
 				bgp_zebra_withdraw(p, old_select, bgp, safi);
 
-			bgp_zebra_announce(dest, p, new_select, bgp, afi, safi);
+			bgp_zebra_route_install(dest, new_select, bgp, true);
 		} else {
 			/* Withdraw the route from the kernel. */
 			if (old_select && old_select->type == ZEBRA_ROUTE_BGP
@@ -3514,7 +3511,8 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 				|| old_select->sub_type == BGP_ROUTE_AGGREGATE
 				|| old_select->sub_type == BGP_ROUTE_IMPORTED))
 
-				bgp_zebra_withdraw(p, old_select, bgp, safi);
+				bgp_zebra_route_install(dest, old_select, bgp,
+							false);
 		}
 	}
 
@@ -10395,14 +10393,14 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				import ? ", import-check enabled" : "");
 		}
 	} else {
-		if (bpi_ultimate->extra && bpi_ultimate->extra->igpmetric) {
+		if (bpi_ultimate->igpmetric) {
 			if (json_paths)
 				json_object_int_add(
 					json_nexthop_global, "metric",
-					bpi_ultimate->extra->igpmetric);
+					bpi_ultimate->igpmetric);
 			else
 				vty_out(vty, " (metric %u)",
-					bpi_ultimate->extra->igpmetric);
+					bpi_ultimate->igpmetric);
 		}
 
 		/* IGP cost is 0, display this only for json */
@@ -204,9 +204,6 @@ struct bgp_path_info_extra {
 	/** List of aggregations that suppress this path. */
 	struct list *aggr_suppressors;
 
-	/* Nexthop reachability check.  */
-	uint32_t igpmetric;
-
 	/* MPLS label(s) - VNI(s) for EVPN-VxLAN  */
 	mpls_label_t label[BGP_MAX_LABELS];
 	uint32_t num_labels;
@@ -345,6 +342,12 @@ struct bgp_path_info {
 	uint32_t addpath_rx_id;
 	struct bgp_addpath_info_data tx_addpath;
 
+	/* Nexthop reachability check.  Kept here rather than in extra so
+	 * that iBGP paths do not need an ancillary allocation just to
+	 * carry the IGP cost.
+	 */
+	uint32_t igpmetric;
+
 	union {
 		struct bgp_mplsvpn_label_nh blnc;
 		struct bgp_mplsvpn_nh_label_bind bmnc;
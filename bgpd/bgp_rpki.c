@@ -25,6 +25,8 @@
 #include "memory.h"
 #include "frrevent.h"
 #include "filter.h"
+#include "table.h"
+#include "sockopt.h"
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_table.h"
 #include "bgp_advertise.h"
@@ -55,6 +57,23 @@ DEFINE_MTYPE_STATIC(BGPD, BGP_RPKI_REVALIDATE, "BGP RPKI Revalidation");
 
 static struct event *t_rpki_sync;
 
+/*
+ * ROA prefixes whose records changed and whose covered routes still have
+ * to be revalidated.  Keeping them in a prefix table coalesces a burst of
+ * records for the same address space into a single walk of the covering
+ * subtree of each RIB, and all walks run from one event that yields.
+ */
+static struct route_table *rpki_revalidate_pending[AFI_MAX];
+static struct event *t_rpki_revalidate;
+
+/* Max number of records read off the sync socket per wakeup */
+#define RPKI_SYNC_READ_BATCH 1024
+
+/* Send buffer of the sync socket.  Running out of it makes us fall back to
+ * revalidating every route, so leave room for a full cache reload.
+ */
+#define RPKI_SYNC_SOCKET_BUFSIZE (4 * 1024 * 1024)
+
 #define RPKI_DEBUG(...)                                                        \
 	if (rpki_debug) {                                                      \
 		zlog_debug("RPKI: " __VA_ARGS__);                              \
@@ -374,40 +393,110 @@ static void pfx_record_to_prefix(struct pfx_record *record,
 	}
 }
 
-struct rpki_revalidate_prefix {
-	struct bgp *bgp;
-	struct prefix prefix;
-	afi_t afi;
-	safi_t safi;
-};
-
-static void rpki_revalidate_prefix(struct event *thread)
+static void revalidate_bgp_subtree(struct bgp *bgp, const struct prefix *prefix,
+				   afi_t afi, safi_t safi)
 {
-	struct rpki_revalidate_prefix *rrp = EVENT_ARG(thread);
 	struct bgp_dest *match, *node;
 
-	match = bgp_table_subtree_lookup(rrp->bgp->rib[rrp->afi][rrp->safi],
-					 &rrp->prefix);
+	match = bgp_table_subtree_lookup(bgp->rib[afi][safi], prefix);
 
 	node = match;
 
 	while (node) {
 		if (bgp_dest_has_bgp_path_info_data(node)) {
-			revalidate_bgp_node(node, rrp->afi, rrp->safi);
+			revalidate_bgp_node(node, afi, safi);
 		}
 
 		node = bgp_route_next_until(node, match);
 	}
+}
 
-	XFREE(MTYPE_BGP_RPKI_REVALIDATE, rrp);
+static void rpki_revalidate_pending_add(struct prefix *prefix)
+{
+	afi_t afi = family2afi(prefix->family);
+	struct route_node *rn;
+
+	apply_mask(prefix);
+
+	/* Already covered by a pending walk */
+	rn = route_node_match(rpki_revalidate_pending[afi], prefix);
+	if (rn) {
+		route_unlock_node(rn);
+		return;
+	}
+
+	/* The lock taken here is held for as long as the node is pending */
+	rn = route_node_get(rpki_revalidate_pending[afi], prefix);
+	rn->info = (void *)1;
 }
 
-static void bgpd_sync_callback(struct event *thread)
+static void rpki_revalidate_pending_flush(void)
 {
-	struct bgp *bgp;
+	struct route_node *rn;
+	afi_t afi;
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+		if (!rpki_revalidate_pending[afi])
+			continue;
+
+		for (rn = route_top(rpki_revalidate_pending[afi]); rn;
+		     rn = route_next(rn)) {
+			if (!rn->info)
+				continue;
+			rn->info = NULL;
+			route_unlock_node(rn);
+		}
+	}
+}
+
+static void rpki_revalidate_pending_run(struct event *thread)
+{
+	struct route_node *rn;
 	struct listnode *node;
+	struct bgp *bgp;
+	afi_t afi;
+	safi_t safi;
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+		if (!rpki_revalidate_pending[afi])
+			continue;
+
+		for (rn = route_top(rpki_revalidate_pending[afi]); rn;
+		     rn = route_next(rn)) {
+			if (!rn->info)
+				continue;
+
+			for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+				for (safi = SAFI_UNICAST; safi < SAFI_MAX;
+				     safi++) {
+					if (!bgp->rib[afi][safi])
+						continue;
+
+					revalidate_bgp_subtree(bgp, &rn->p, afi,
+							       safi);
+				}
+			}
+
+			rn->info = NULL;
+			route_unlock_node(rn);
+
+			if (event_should_yield(thread)) {
+				route_unlock_node(rn);
+				event_add_event(bm->master,
+						rpki_revalidate_pending_run,
+						NULL, 0, &t_rpki_revalidate);
+				return;
+			}
+		}
+	}
+}
+
+static void bgpd_sync_callback(struct event *thread)
+{
 	struct prefix prefix;
 	struct pfx_record rec;
+	unsigned int count;
+	int retval;
 
 	event_add_read(bm->master, bgpd_sync_callback, NULL,
 		       rpki_sync_socket_bgpd, NULL);
@@ -419,39 +508,32 @@ static void bgpd_sync_callback(struct event *thread)
 
 		atomic_store_explicit(&rtr_update_overflow, 0,
 				      memory_order_seq_cst);
+		rpki_revalidate_pending_flush();
+		EVENT_OFF(t_rpki_revalidate);
 		revalidate_all_routes();
 		return;
 	}
 
-	int retval =
-		read(rpki_sync_socket_bgpd, &rec, sizeof(struct pfx_record));
-	if (retval != sizeof(struct pfx_record)) {
-		RPKI_DEBUG("Could not read from rpki_sync_socket_bgpd");
-		return;
-	}
-	pfx_record_to_prefix(&rec, &prefix);
-
-	afi_t afi = (rec.prefix.ver == LRTR_IPV4) ? AFI_IP : AFI_IP6;
-
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
-		safi_t safi;
-
-		for (safi = SAFI_UNICAST; safi < SAFI_MAX; safi++) {
-			struct bgp_table *table = bgp->rib[afi][safi];
-			struct rpki_revalidate_prefix *rrp;
-
-			if (!table)
-				continue;
-
-			rrp = XCALLOC(MTYPE_BGP_RPKI_REVALIDATE, sizeof(*rrp));
-			rrp->bgp = bgp;
-			rrp->prefix = prefix;
-			rrp->afi = afi;
-			rrp->safi = safi;
-			event_add_event(bm->master, rpki_revalidate_prefix, rrp,
-					0, &bgp->t_revalidate[afi][safi]);
+	/* Drain what the rtr thread queued up, the revalidation itself is
+	 * done later for all of it at once.
+	 */
+	for (count = 0; count < RPKI_SYNC_READ_BATCH; count++) {
+		retval = read(rpki_sync_socket_bgpd, &rec,
+			      sizeof(struct pfx_record));
+		if (retval != sizeof(struct pfx_record)) {
+			if (retval < 0 && ERRNO_IO_RETRY(errno))
+				break;
+			RPKI_DEBUG("Could not read from rpki_sync_socket_bgpd");
+			break;
 		}
+
+		pfx_record_to_prefix(&rec, &prefix);
+		rpki_revalidate_pending_add(&prefix);
 	}
+
+	if (count)
+		event_add_event(bm->master, rpki_revalidate_pending_run, NULL,
+				0, &t_rpki_revalidate);
 }
 
 static void revalidate_bgp_node(struct bgp_dest *bgp_dest, afi_t afi,
@@ -579,6 +661,8 @@ static void rpki_init_sync_socket(void)
 		goto err;
 	}
 
+	setsockopt_so_sendbuf(rpki_sync_socket_rtr, RPKI_SYNC_SOCKET_BUFSIZE);
+	setsockopt_so_recvbuf(rpki_sync_socket_bgpd, RPKI_SYNC_SOCKET_BUFSIZE);
 
 	event_add_read(bm->master, bgpd_sync_callback, NULL,
 		       rpki_sync_socket_bgpd, NULL);
@@ -605,15 +689,25 @@ static int bgp_rpki_init(struct event_loop *master)
 	expire_interval = EXPIRE_INTERVAL_DEFAULT;
 	retry_interval = RETRY_INTERVAL_DEFAULT;
 	install_cli_commands();
+	rpki_revalidate_pending[AFI_IP] = route_table_init();
+	rpki_revalidate_pending[AFI_IP6] = route_table_init();
 	rpki_init_sync_socket();
 	return 0;
 }
 
 static int bgp_rpki_fini(void)
 {
+	afi_t afi;
+
 	stop();
 	list_delete(&cache_list);
 
+	EVENT_OFF(t_rpki_revalidate);
+	rpki_revalidate_pending_flush();
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		if (rpki_revalidate_pending[afi])
+			route_table_finish(rpki_revalidate_pending[afi]);
+
 	close(rpki_sync_socket_rtr);
 	close(rpki_sync_socket_bgpd);
 
@@ -6,6 +6,10 @@
 #ifndef _QUAGGA_BGP_TABLE_H
 #define _QUAGGA_BGP_TABLE_H
 
+/* needed before bgpd.h, struct bgp_master embeds the list head */
+#include "typesafe.h"
+PREDECL_DLIST(zebra_announce);
+
 #include "mpls.h"
 #include "table.h"
 #include "queue.h"
@@ -76,6 +80,10 @@ struct bgp_dest {
 
 	STAILQ_ENTRY(bgp_dest) pq;
 
+	/* Pending zebra install/withdraw of za_bgp_pi */
+	struct zebra_announce_item zai;
+	struct bgp_path_info *za_bgp_pi;
+
 	uint64_t version;
 
 	mpls_label_t local_label;
@@ -91,12 +99,16 @@ struct bgp_dest {
 #define BGP_NODE_LABEL_REQUESTED        (1 << 7)
 #define BGP_NODE_SOFT_RECONFIG (1 << 8)
 #define BGP_NODE_PROCESS_CLEAR (1 << 9)
+#define BGP_NODE_SCHEDULE_FOR_INSTALL (1 << 10)
+#define BGP_NODE_SCHEDULE_FOR_DELETE (1 << 11)
 
 	struct bgp_addpath_node_data tx_addpath;
 
 	enum bgp_path_selection_reason reason;
 };
 
+DECLARE_DLIST(zebra_announce, struct bgp_dest, zai);
+
 extern void bgp_delete_listnode(struct bgp_dest *dest);
 /*
  * bgp_table_iter_t
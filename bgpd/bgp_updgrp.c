@@ -875,6 +875,9 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 				json_subgrp, "needsRefresh",
 				CHECK_FLAG(subgrp->flags,
 					   SUBGRP_FLAG_NEEDS_REFRESH));
+			json_object_boolean_add(json_subgrp,
+						"tableWalkInProgress",
+						!!subgrp->walk);
 		} else {
 			vty_out(vty, "    Join events: %u\n",
 				subgrp->join_events);
@@ -894,6 +897,8 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 				(UPDGRP_INST(subgrp->update_group))
 					->coalesce_time,
 				subgrp->t_coalesce ? "(Running)" : "");
+			if (subgrp->walk)
+				vty_out(vty, "    Table walk: in progress\n");
 			vty_out(vty, "    Version: %" PRIu64 "\n",
 				subgrp->version);
 			vty_out(vty, "    Packet queue length: %d\n",
@@ -1113,6 +1118,7 @@ static void update_subgroup_delete(struct update_subgroup *subgrp)
 
 	EVENT_OFF(subgrp->t_merge_check);
 	EVENT_OFF(subgrp->t_coalesce);
+	subgroup_walk_leave(subgrp);
 
 	bpacket_queue_cleanup(SUBGRP_PKTQ(subgrp));
 	subgroup_clear_table(subgrp);
@@ -1282,6 +1288,13 @@ static struct update_subgroup *update_subgroup_find(struct update_group *updgrp,
 		if (update_subgroup_needs_refresh(subgrp))
 			continue;
 
+		/*
+		 * A subgroup that is part way through the table walk has
+		 * already advertised some of it without the new peer.
+		 */
+		if (subgrp->walk)
+			continue;
+
 		break;
 	}
 
@@ -1318,6 +1331,13 @@ static bool update_subgroup_ready_for_merge(struct update_subgroup *subgrp)
 	if (update_subgroup_needs_refresh(subgrp))
 		return false;
 
+	/*
+	 * Not ready while the table is still being walked for it: its
+	 * version only reflects the part of the table walked so far.
+	 */
+	if (subgrp->walk)
+		return false;
+
 	return true;
 }
 
@@ -1671,11 +1691,16 @@ static int updgrp_policy_update_walkcb(struct update_group *updgrp, void *arg)
 	}
 
 	UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
-		/* Avoid supressing duplicate routes later
-		 * when processing in subgroup_announce_table().
+		/*
+		 * A policy change only alters the outcome for the prefixes
+		 * the changed entries actually match.  Do not force updates
+		 * here: subgroup_announce_table() re-evaluates every path,
+		 * but the adj-rib-out check, which compares the full
+		 * attribute and not just its hash, then suppresses the
+		 * prefixes whose result is unchanged, so only the
+		 * affected prefixes are re-advertised or withdrawn.  An
+		 * explicit "clear bgp soft out" still forces a full resend.
 		 */
-		SET_FLAG(subgrp->sflags, SUBGRP_STATUS_FORCE_UPDATES);
-
 		if (changed) {
 			if (bgp_debug_update(NULL, NULL, updgrp, 0))
 				zlog_debug(
@@ -1780,9 +1805,11 @@ void update_subgroup_split_peer(struct peer_af *paf,
 {
 	struct update_subgroup *old_subgrp, *subgrp;
 	uint64_t old_id;
+	bool walking;
 
 
 	old_subgrp = paf->subgroup;
+	walking = !!old_subgrp->walk;
 
 	if (!updgrp)
 		updgrp = old_subgrp->update_group;
@@ -1798,6 +1825,9 @@ void update_subgroup_split_peer(struct peer_af *paf,
 		subgrp = old_subgrp;
 		old_id = old_subgrp->update_group->id;
 
+		/* The table walk belongs to the old update group */
+		subgroup_walk_leave(subgrp);
+
 		if (bgp_debug_peer_updout_enabled(paf->peer->host)) {
 			UPDGRP_PEER_DBG_DIS(old_subgrp->update_group);
 		}
@@ -1823,6 +1853,14 @@ void update_subgroup_split_peer(struct peer_af *paf,
 		 */
 		update_subgroup_set_needs_refresh(subgrp, 1);
 
+		/*
+		 * If the table was still being walked for it, start over with
+		 * the walk of the new update group. It covers the whole table,
+		 * so it also does the refresh.
+		 */
+		if (walking)
+			subgroup_walk_join(subgrp);
+
 		SUBGRP_INCR_STAT(subgrp, updgrp_switch_events);
 		return;
 	}
@@ -1862,6 +1900,13 @@ void update_subgroup_split_peer(struct peer_af *paf,
 	update_subgroup_remove_peer(paf->subgroup, paf);
 
 	update_subgroup_add_peer(subgrp, paf, 1);
+
+	/*
+	 * The old subgroup was still getting the table, so the copied adj-out
+	 * is partial: walk the whole table for the new one.
+	 */
+	if (walking)
+		subgroup_walk_join(subgrp);
 }
 
 void update_bgp_group_init(struct bgp *bgp)
@@ -90,6 +90,9 @@ struct bpacket {
 	bpacket_attr_vec_arr arr;
 
 	unsigned int ver;
+
+	/* buffer now belongs to a peer's output queue, don't free it */
+	bool buffer_detached;
 };
 
 struct bpacket_queue {
@@ -101,6 +104,8 @@ struct bpacket_queue {
 	unsigned int max_count_reached_count;
 };
 
+struct update_walk;
+
 struct update_group {
 	/* back pointer to the BGP instance */
 	struct bgp *bgp;
@@ -132,6 +137,9 @@ struct update_group {
 	uint32_t subgrps_deleted;
 
 	uint32_t num_dbg_en_peers;
+
+	/* table walk announcing routes to new subgroups, if running */
+	struct update_walk *walk;
 };
 
 /*
@@ -201,6 +209,16 @@ struct update_subgroup {
 
 	struct event *t_merge_check;
 
+	/*
+	 * Shared table walk of the update group this subgroup is getting
+	 * the table from, the node it joined the walk at (NULL if it joined
+	 * at the top of the table), and whether the walk has wrapped around
+	 * since then.
+	 */
+	struct update_walk *walk;
+	struct bgp_dest *walk_join;
+	bool walk_wrapped;
+
 	/* table version that the subgroup has caught up to. */
 	uint64_t version;
 
@@ -425,6 +443,8 @@ extern void update_group_show_packet_queue(struct bgp *bgp, afi_t afi,
 					   safi_t safi, struct vty *vty,
 					   uint64_t id);
 extern void subgroup_announce_route(struct update_subgroup *subgrp);
+extern void subgroup_walk_join(struct update_subgroup *subgrp);
+extern void subgroup_walk_leave(struct update_subgroup *subgrp);
 extern void subgroup_announce_all(struct update_subgroup *subgrp);
 
 extern void subgroup_default_originate(struct update_subgroup *subgrp,
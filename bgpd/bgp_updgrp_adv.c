@@ -350,21 +350,17 @@ static void updgrp_show_adj(struct bgp *bgp, afi_t afi, safi_t safi,
 	update_group_af_walk(bgp, afi, safi, updgrp_show_adj_walkcb, &ctx);
 }
 
-static void subgroup_coalesce_timer(struct event *thread)
+/*
+ * subgroup_announce_kick
+ *
+ * Fire the route advertisement timer of the subgroup's peers right away.
+ */
+static void subgroup_announce_kick(struct update_subgroup *subgrp)
 {
-	struct update_subgroup *subgrp;
 	struct bgp *bgp;
 	safi_t safi;
 
-	subgrp = EVENT_ARG(thread);
-	if (bgp_debug_update(NULL, NULL, subgrp->update_group, 0))
-		zlog_debug("u%" PRIu64 ":s%" PRIu64" announcing routes upon coalesce timer expiry(%u ms)",
-			   (SUBGRP_UPDGRP(subgrp))->id, subgrp->id,
-			   subgrp->v_coalesce);
-	subgrp->t_coalesce = NULL;
-	subgrp->v_coalesce = 0;
 	bgp = SUBGRP_INST(subgrp);
-	subgroup_announce_route(subgrp);
 	safi = SUBGRP_SAFI(subgrp);
 
 	/* While the announce_route() may kick off the route advertisement timer
@@ -392,6 +388,32 @@ static void subgroup_coalesce_timer(struct event *thread)
 	}
 }
 
+static void subgroup_coalesce_timer(struct event *thread)
+{
+	struct update_subgroup *subgrp;
+	safi_t safi;
+
+	subgrp = EVENT_ARG(thread);
+	if (bgp_debug_update(NULL, NULL, subgrp->update_group, 0))
+		zlog_debug("u%" PRIu64 ":s%" PRIu64" announcing routes upon coalesce timer expiry(%u ms)",
+			   (SUBGRP_UPDGRP(subgrp))->id, subgrp->id,
+			   subgrp->v_coalesce);
+	subgrp->t_coalesce = NULL;
+	subgrp->v_coalesce = 0;
+	safi = SUBGRP_SAFI(subgrp);
+
+	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN)
+		subgroup_walk_join(subgrp);
+	else
+		subgroup_announce_route(subgrp);
+
+	/* The table walk kicks the timers itself as it goes */
+	if (subgrp->walk)
+		return;
+
+	subgroup_announce_kick(subgrp);
+}
+
 static int update_group_announce_walkcb(struct update_group *updgrp, void *arg)
 {
 	struct update_subgroup *subgrp;
@@ -496,6 +518,29 @@ bgp_advertise_clean_subgroup(struct update_subgroup *subgrp,
 	return next;
 }
 
+/*
+ * Return true if 'attr' is exactly what this adj-rib-out entry already
+ * carries, either queued for advertisement or last sent.  The attribute
+ * hash alone is not enough: it does not cover every field (e.g. the
+ * attribute flags) and may collide.  'attr' is fresh out of outbound
+ * policy, so its AS path and communities are compared by value.
+ */
+static bool bgp_adj_out_attr_same(const struct bgp_adj_out *adj,
+				  uint32_t attr_hash, const struct attr *attr)
+{
+	const struct attr *cur;
+
+	if (adj->attr_hash != attr_hash)
+		return false;
+
+	if (adj->adv)
+		cur = adj->adv->baa ? adj->adv->baa->attr : NULL;
+	else
+		cur = adj->attr;
+
+	return cur && bgp_attr_same(cur, attr);
+}
+
 void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 			      struct update_subgroup *subgrp, struct attr *attr,
 			      struct bgp_path_info *path)
@@ -545,7 +590,7 @@ void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 	 */
 	if (CHECK_FLAG(bgp->flags, BGP_FLAG_SUPPRESS_DUPLICATES)
 	    && !CHECK_FLAG(subgrp->sflags, SUBGRP_STATUS_FORCE_UPDATES)
-	    && adj->attr_hash == attr_hash) {
+	    && bgp_adj_out_attr_same(adj, attr_hash, attr)) {
 		if (BGP_DEBUG(update, UPDATE_OUT)) {
 			char attr_str[BUFSIZ] = {0};
 
@@ -703,6 +748,54 @@ void subgroup_clear_table(struct update_subgroup *subgrp)
 		bgp_adj_out_remove_subgroup(aout->dest, aout, subgrp);
 }
 
+/*
+ * subgroup_announce_dest
+ *
+ * Announce the selected path(s) of one table node to a subgroup whose
+ * table is being (re)walked.
+ */
+static void subgroup_announce_dest(struct update_subgroup *subgrp,
+				   struct bgp_dest *dest, safi_t safi_rib)
+{
+	struct bgp_path_info *ri;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+	bool addpath_capable;
+
+	peer = SUBGRP_PEER(subgrp);
+	afi = SUBGRP_AFI(subgrp);
+	safi = SUBGRP_SAFI(subgrp);
+	addpath_capable = bgp_addpath_encode_tx(peer, afi, safi);
+
+	if (addpath_capable)
+		subgrp_announce_addpath_best_selected(dest, subgrp);
+
+	for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next) {
+
+		if (!bgp_check_selected(ri, peer, addpath_capable, afi,
+					safi_rib))
+			continue;
+
+		/* If default originate is enabled for
+		 * the peer, do not send explicit
+		 * withdraw. This will prevent deletion
+		 * of default route advertised through
+		 * default originate
+		 */
+		if (CHECK_FLAG(peer->af_flags[afi][safi],
+			       PEER_FLAG_DEFAULT_ORIGINATE) &&
+		    is_default_prefix(bgp_dest_get_prefix(dest)))
+			break;
+
+		if (CHECK_FLAG(ri->flags, BGP_PATH_SELECTED))
+			subgroup_process_announce_selected(
+				subgrp, ri, dest, afi, safi_rib,
+				bgp_addpath_id_for_peer(peer, afi, safi_rib,
+							&ri->tx_addpath));
+	}
+}
+
 /*
  * subgroup_announce_table
  */
@@ -710,17 +803,14 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 			     struct bgp_table *table)
 {
 	struct bgp_dest *dest;
-	struct bgp_path_info *ri;
 	struct peer *peer;
 	afi_t afi;
 	safi_t safi;
 	safi_t safi_rib;
-	bool addpath_capable;
 
 	peer = SUBGRP_PEER(subgrp);
 	afi = SUBGRP_AFI(subgrp);
 	safi = SUBGRP_SAFI(subgrp);
-	addpath_capable = bgp_addpath_encode_tx(peer, afi, safi);
 
 	if (safi == SAFI_LABELED_UNICAST)
 		safi_rib = SAFI_UNICAST;
@@ -730,6 +820,9 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	if (!table)
 		table = peer->bgp->rib[afi][safi_rib];
 
+	/* This walk covers everything the shared one was going to send */
+	subgroup_walk_leave(subgrp);
+
 	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN
 	    && CHECK_FLAG(peer->af_flags[afi][safi],
 			  PEER_FLAG_DEFAULT_ORIGINATE))
@@ -738,36 +831,9 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	subgrp->pscount = 0;
 	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest))
+		subgroup_announce_dest(subgrp, dest, safi_rib);
 
-		if (addpath_capable)
-			subgrp_announce_addpath_best_selected(dest, subgrp);
-
-		for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next) {
-
-			if (!bgp_check_selected(ri, peer, addpath_capable, afi,
-						safi_rib))
-				continue;
-
-			/* If default originate is enabled for
-			 * the peer, do not send explicit
-			 * withdraw. This will prevent deletion
-			 * of default route advertised through
-			 * default originate
-			 */
-			if (CHECK_FLAG(peer->af_flags[afi][safi],
-				       PEER_FLAG_DEFAULT_ORIGINATE) &&
-			    is_default_prefix(bgp_dest_get_prefix(dest)))
-				break;
-
-			if (CHECK_FLAG(ri->flags, BGP_PATH_SELECTED))
-				subgroup_process_announce_selected(
-					subgrp, ri, dest, afi, safi_rib,
-					bgp_addpath_id_for_peer(
-						peer, afi, safi_rib,
-						&ri->tx_addpath));
-		}
-	}
 	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
 
 	/*
@@ -786,6 +852,253 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	update_subgroup_trigger_merge_check(subgrp, 0);
 }
 
+/*
+ * subgroup_announce_deferred
+ *
+ * First update is deferred until ORF or ROUTE-REFRESH is received
+ */
+static bool subgroup_announce_deferred(struct update_subgroup *subgrp)
+{
+	struct peer *onlypeer;
+
+	onlypeer = ((SUBGRP_PCOUNT(subgrp) == 1) ? (SUBGRP_PFIRST(subgrp))->peer
+						 : NULL);
+	return onlypeer &&
+	       CHECK_FLAG(onlypeer->af_sflags[SUBGRP_AFI(subgrp)]
+					     [SUBGRP_SAFI(subgrp)],
+			  PEER_STATUS_ORF_WAIT_REFRESH);
+}
+
+/*
+ * Shared table walk.
+ *
+ * When a subgroup's coalesce timer expires, it does not walk the table on
+ * its own. Each update group runs at most one walk, which goes through the
+ * table in slices and yields to the event loop between them. A subgroup
+ * that comes along while the walk is running joins it at the node it is
+ * at, follows it to the end of the table, and then around from the top
+ * until it is back at the node it joined at. Peers that reconnect one
+ * after the other thus share a single pass over the table, instead of
+ * each of them blocking the main thread for a full walk.
+ *
+ * Outbound policy is still applied per subgroup; subgroups that end up
+ * with the same adj-out are merged once the walk is done with them.
+ */
+struct update_walk {
+	struct update_group *updgrp;
+
+	/* Locked, as is the next node to process */
+	struct bgp_table *table;
+	struct bgp_dest *dest;
+
+	/* dest is the first node of the table */
+	bool at_top;
+
+	unsigned int members;
+
+	struct event *t_walk;
+};
+
+static void update_walk_free(struct update_walk *walk)
+{
+	EVENT_OFF(walk->t_walk);
+
+	if (walk->dest)
+		bgp_dest_unlock_node(walk->dest);
+	bgp_table_unlock(walk->table);
+
+	walk->updgrp->walk = NULL;
+	XFREE(MTYPE_BGP_UPD_WALK, walk);
+}
+
+static void subgroup_walk_detach(struct update_subgroup *subgrp)
+{
+	struct update_walk *walk = subgrp->walk;
+
+	if (subgrp->walk_join)
+		bgp_dest_unlock_node(subgrp->walk_join);
+
+	subgrp->walk = NULL;
+	subgrp->walk_join = NULL;
+	subgrp->walk_wrapped = false;
+	walk->members--;
+
+	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+}
+
+/*
+ * subgroup_walk_done
+ *
+ * The walk has gone through the whole table for this subgroup.
+ */
+static void subgroup_walk_done(struct update_subgroup *subgrp)
+{
+	struct bgp_table *table = subgrp->walk->table;
+
+	subgroup_walk_detach(subgrp);
+
+	if (BGP_DEBUG(update_groups, UPDATE_GROUPS))
+		zlog_debug("u%" PRIu64 ":s%" PRIu64 " table walk done",
+			   subgrp->update_group->id, subgrp->id);
+
+	/* See subgroup_announce_table() */
+	subgrp->version = MAX(subgrp->version, table->version);
+	update_subgroup_trigger_merge_check(subgrp, 0);
+
+	subgroup_announce_kick(subgrp);
+}
+
+static void update_walk_run(struct event *thread)
+{
+	struct update_walk *walk = EVENT_ARG(thread);
+	struct update_group *updgrp = walk->updgrp;
+	struct update_subgroup *subgrp;
+	safi_t safi_rib;
+
+	if (UPDGRP_SAFI(updgrp) == SAFI_LABELED_UNICAST)
+		safi_rib = SAFI_UNICAST;
+	else
+		safi_rib = UPDGRP_SAFI(updgrp);
+
+	while (walk->members) {
+		if (!walk->dest) {
+			/*
+			 * End of the table: subgroups that joined at the top
+			 * are done, the others go on from the top.
+			 */
+			UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
+				if (subgrp->walk != walk)
+					continue;
+
+				if (!subgrp->walk_join || subgrp->walk_wrapped)
+					subgroup_walk_done(subgrp);
+				else
+					subgrp->walk_wrapped = true;
+			}
+
+			if (!walk->members)
+				break;
+
+			walk->dest = bgp_table_top(walk->table);
+			walk->at_top = true;
+			continue;
+		}
+
+		UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
+			if (subgrp->walk != walk)
+				continue;
+
+			if (subgrp->walk_wrapped &&
+			    subgrp->walk_join == walk->dest) {
+				subgroup_walk_done(subgrp);
+				continue;
+			}
+
+			subgroup_announce_dest(subgrp, walk->dest, safi_rib);
+		}
+
+		walk->dest = bgp_route_next(walk->dest);
+		walk->at_top = false;
+
+		if (event_should_yield(thread))
+			break;
+	}
+
+	if (!walk->members) {
+		update_walk_free(walk);
+		return;
+	}
+
+	UPDGRP_FOREACH_SUBGRP (updgrp, subgrp) {
+		if (subgrp->walk == walk)
+			subgroup_announce_kick(subgrp);
+	}
+
+	event_add_event(bm->master, update_walk_run, walk, 0, &walk->t_walk);
+}
+
+/*
+ * subgroup_walk_join
+ *
+ * Have the update group's table walk announce the whole table to the
+ * subgroup, starting one if none is running.
+ */
+void subgroup_walk_join(struct update_subgroup *subgrp)
+{
+	struct update_group *updgrp = subgrp->update_group;
+	struct update_walk *walk;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+	safi_t safi_rib;
+
+	subgroup_walk_leave(subgrp);
+
+	if (update_subgroup_needs_refresh(subgrp))
+		update_subgroup_set_needs_refresh(subgrp, 0);
+
+	if (subgroup_announce_deferred(subgrp))
+		return;
+
+	peer = SUBGRP_PEER(subgrp);
+	afi = SUBGRP_AFI(subgrp);
+	safi = SUBGRP_SAFI(subgrp);
+
+	if (safi == SAFI_LABELED_UNICAST)
+		safi_rib = SAFI_UNICAST;
+	else
+		safi_rib = safi;
+
+	walk = updgrp->walk;
+	if (!walk) {
+		walk = XCALLOC(MTYPE_BGP_UPD_WALK, sizeof(*walk));
+		walk->updgrp = updgrp;
+		walk->table = peer->bgp->rib[afi][safi_rib];
+		bgp_table_lock(walk->table);
+		walk->dest = bgp_table_top(walk->table);
+		walk->at_top = true;
+		updgrp->walk = walk;
+
+		event_add_event(bm->master, update_walk_run, walk, 0,
+				&walk->t_walk);
+	}
+
+	if (CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_DEFAULT_ORIGINATE))
+		subgroup_default_originate(subgrp, 0);
+
+	subgrp->pscount = 0;
+	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+
+	subgrp->walk = walk;
+	if (walk->dest && !walk->at_top)
+		subgrp->walk_join = bgp_dest_lock_node(walk->dest);
+	subgrp->walk_wrapped = false;
+	walk->members++;
+
+	if (BGP_DEBUG(update_groups, UPDATE_GROUPS))
+		zlog_debug("u%" PRIu64 ":s%" PRIu64 " joined table walk%s",
+			   updgrp->id, subgrp->id,
+			   subgrp->walk_join ? " in progress" : "");
+}
+
+/*
+ * subgroup_walk_leave
+ *
+ * Stop the update group's table walk from announcing to the subgroup.
+ */
+void subgroup_walk_leave(struct update_subgroup *subgrp)
+{
+	struct update_walk *walk = subgrp->walk;
+
+	if (!walk)
+		return;
+
+	subgroup_walk_detach(subgrp);
+
+	if (!walk->members)
+		update_walk_free(walk);
+}
+
 /*
  * subgroup_announce_route
  *
@@ -795,20 +1108,12 @@ void subgroup_announce_route(struct update_subgroup *subgrp)
 {
 	struct bgp_dest *dest;
 	struct bgp_table *table;
-	struct peer *onlypeer;
 
 	if (update_subgroup_needs_refresh(subgrp)) {
 		update_subgroup_set_needs_refresh(subgrp, 0);
 	}
 
-	/*
-	 * First update is deferred until ORF or ROUTE-REFRESH is received
-	 */
-	onlypeer = ((SUBGRP_PCOUNT(subgrp) == 1) ? (SUBGRP_PFIRST(subgrp))->peer
-						 : NULL);
-	if (onlypeer && CHECK_FLAG(onlypeer->af_sflags[SUBGRP_AFI(subgrp)]
-						      [SUBGRP_SAFI(subgrp)],
-				   PEER_STATUS_ORF_WAIT_REFRESH))
+	if (subgroup_announce_deferred(subgrp))
 		return;
 
 	if (SUBGRP_SAFI(subgrp) != SAFI_MPLS_VPN
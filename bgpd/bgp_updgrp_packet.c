@@ -61,7 +61,7 @@ struct bpacket *bpacket_alloc(void)
 
 void bpacket_free(struct bpacket *pkt)
 {
-	if (pkt->buffer)
+	if (pkt->buffer && !pkt->buffer_detached)
 		stream_free(pkt->buffer);
 	pkt->buffer = NULL;
 	XFREE(MTYPE_BGP_PACKET, pkt);
@@ -329,6 +329,18 @@ void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty)
 	return;
 }
 
+/*
+ * Is paf the last peer the packet has to be sent to?  If the packet is also
+ * at the head of its queue, it is freed as soon as paf advances past it.
+ */
+static bool bpacket_is_last_consumer(struct bpacket *pkt, struct peer_af *paf)
+{
+	if (LIST_FIRST(&pkt->peers) != paf || LIST_NEXT(paf, pkt_train))
+		return false;
+
+	return bpacket_queue_first(PAF_PKTQ(paf)) == pkt;
+}
+
 struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 					 struct peer_af *paf)
 {
@@ -337,7 +349,17 @@ struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 	struct peer *peer;
 	struct bgp_filter *filter;
 
-	s = stream_dup(pkt->buffer);
+	/*
+	 * The last peer to get the packet can take the encoded buffer
+	 * itself instead of a copy, which saves copying it once per packet
+	 * for every single peer subgroup.  bpacket_queue_advance_peer() frees
+	 * the packet right after, without touching the buffer.
+	 */
+	if (bpacket_is_last_consumer(pkt, paf)) {
+		s = pkt->buffer;
+		pkt->buffer_detached = true;
+	} else
+		s = stream_dup(pkt->buffer);
 	peer = PAF_PEER(paf);
 
 	vec = &pkt->arr.entries[BGP_ATTR_VEC_NH];
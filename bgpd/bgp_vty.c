@@ -9912,6 +9912,7 @@ DEFPY (af_rt_vpn_imexport,
 						&bgp->vpn_policy[afi].rtlist[dir]);
 			bgp->vpn_policy[afi].rtlist[dir] = NULL;
 		}
+		vpn_leak_rt_import_invalidate();
 
 		vpn_leak_postchange(dir, afi, bgp_get_default(), bgp);
 	}
@@ -11162,6 +11163,14 @@ DEFUN (show_bgp_memory,
 			mtype_memstr(memstrbuf, sizeof(memstrbuf),
 				     count * sizeof(struct bgp_path_info_extra_vrfleak)));
 
+	count = mtype_stats_alloc(MTYPE_BGP_MPATH_INFO);
+	if (count)
+		vty_out(vty,
+			"%ld BGP multipath info entries, using %s of memory\n",
+			count,
+			mtype_memstr(memstrbuf, sizeof(memstrbuf),
+				     count * sizeof(struct bgp_path_info_mpath)));
+
 	if ((count = mtype_stats_alloc(MTYPE_BGP_STATIC)))
 		vty_out(vty, "%ld Static routes, using %s of memory\n", count,
 			mtype_memstr(memstrbuf, sizeof(memstrbuf),
@@ -14944,6 +14953,9 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 							 memory_order_relaxed));
 		json_object_int_add(json_stat, "totalSent", PEER_TOTAL_TX(p));
 		json_object_int_add(json_stat, "totalRecv", PEER_TOTAL_RX(p));
+		json_object_int_add(json_stat, "writeCalls",
+				    atomic_load_explicit(&p->write_calls,
+							 memory_order_relaxed));
 		json_object_object_add(json_neigh, "messageStats", json_stat);
 	} else {
 		atomic_size_t outq_count, inq_count, open_out, open_in,
@@ -14998,6 +15010,9 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 			dynamic_cap_out, dynamic_cap_in);
 		vty_out(vty, "    Total:         %10u %10u\n",
 			(uint32_t)PEER_TOTAL_TX(p), (uint32_t)PEER_TOTAL_RX(p));
+		vty_out(vty, "    Write calls:   %10u\n",
+			atomic_load_explicit(&p->write_calls,
+					     memory_order_relaxed));
 	}
 
 	if (use_json) {
@@ -1212,6 +1212,26 @@ static bool bgp_zebra_use_nhop_weighted(struct bgp *bgp, struct attr *attr,
 	return true;
 }
 
+/* Drop a pending bgp_zebra_route_install() request for this dest */
+static void bgp_zebra_route_unschedule(struct bgp_dest *dest)
+{
+	struct bgp_table *table;
+
+	if (!CHECK_FLAG(dest->flags, BGP_NODE_SCHEDULE_FOR_INSTALL |
+					     BGP_NODE_SCHEDULE_FOR_DELETE))
+		return;
+
+	zebra_announce_del(&bm->zebra_announce_head, dest);
+	UNSET_FLAG(dest->flags,
+		   BGP_NODE_SCHEDULE_FOR_INSTALL | BGP_NODE_SCHEDULE_FOR_DELETE);
+	bgp_path_info_unlock(dest->za_bgp_pi);
+	dest->za_bgp_pi = NULL;
+
+	table = bgp_dest_table(dest);
+	bgp_dest_unlock_node(dest);
+	bgp_table_unlock(table);
+}
+
 void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 			struct bgp_path_info *info, struct bgp *bgp, afi_t afi,
 			safi_t safi)
@@ -1242,6 +1262,9 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 	uint32_t bos = 0;
 	uint32_t exp = 0;
 
+	/* A direct announcement supersedes whatever was still queued */
+	bgp_zebra_route_unschedule(dest);
+
 	/*
 	 * BGP is installing this route and bgp has been configured
 	 * to suppress announcements until the route has been installed
@@ -1711,6 +1734,8 @@ void bgp_zebra_withdraw(const struct prefix *p, struct bgp_path_info *info,
 	struct zapi_route api;
 	struct peer *peer;
 
+	bgp_zebra_route_unschedule(info->net);
+
 	/*
 	 * If we are withdrawing the route, we don't need to have this
 	 * flag set.  So unset it.
@@ -1747,6 +1772,104 @@ void bgp_zebra_withdraw(const struct prefix *p, struct bgp_path_info *info,
 	zclient_route_send(ZEBRA_ROUTE_DELETE, zclient, &api);
 }
 
+/* Max. number of queued routes sent to zebra per event run */
+#define BGP_ZEBRA_ANNOUNCE_QUANTA 1000
+
+static void bgp_zebra_announce_process(struct event *event)
+{
+	struct bgp_dest *dest;
+	struct bgp_table *table;
+	struct bgp_path_info *pi;
+	bool install;
+	unsigned int count = 0;
+
+	while (count < BGP_ZEBRA_ANNOUNCE_QUANTA) {
+		dest = zebra_announce_pop(&bm->zebra_announce_head);
+		if (!dest)
+			break;
+
+		table = bgp_dest_table(dest);
+		pi = dest->za_bgp_pi;
+		install = CHECK_FLAG(dest->flags,
+				     BGP_NODE_SCHEDULE_FOR_INSTALL);
+
+		UNSET_FLAG(dest->flags, BGP_NODE_SCHEDULE_FOR_INSTALL |
+						BGP_NODE_SCHEDULE_FOR_DELETE);
+		dest->za_bgp_pi = NULL;
+
+		if (install)
+			bgp_zebra_announce(dest, bgp_dest_get_prefix(dest), pi,
+					   table->bgp, table->afi, table->safi);
+		else
+			bgp_zebra_withdraw(bgp_dest_get_prefix(dest), pi,
+					   table->bgp, table->safi);
+
+		bgp_path_info_unlock(pi);
+		bgp_dest_unlock_node(dest);
+		bgp_table_unlock(table);
+		count++;
+	}
+
+	if (zebra_announce_count(&bm->zebra_announce_head))
+		event_add_event(bm->master, bgp_zebra_announce_process, NULL,
+				0, &bm->t_zebra_announce);
+}
+
+/*
+ * Queue the install (or withdraw) of a selected path towards zebra.
+ *
+ * Best path selection only records the outcome here; the zapi messages
+ * are built and written in batches from bgp_zebra_announce_process(), so
+ * a large churn does not interleave route selection with zapi encoding.
+ * Only the last request for a dest is kept.
+ */
+void bgp_zebra_route_install(struct bgp_dest *dest, struct bgp_path_info *info,
+			     struct bgp *bgp, bool install)
+{
+	/* Keep the FIB pending state in sync with the selection, the
+	 * suppress-fib-pending logic consults it before we get to run.
+	 */
+	if (install) {
+		if (BGP_SUPPRESS_FIB_ENABLED(bgp))
+			SET_FLAG(dest->flags, BGP_NODE_FIB_INSTALL_PENDING);
+	} else
+		UNSET_FLAG(dest->flags, BGP_NODE_FIB_INSTALL_PENDING);
+
+	if (CHECK_FLAG(dest->flags, BGP_NODE_SCHEDULE_FOR_INSTALL |
+					     BGP_NODE_SCHEDULE_FOR_DELETE)) {
+		UNSET_FLAG(dest->flags, BGP_NODE_SCHEDULE_FOR_INSTALL |
+						BGP_NODE_SCHEDULE_FOR_DELETE);
+		bgp_path_info_unlock(dest->za_bgp_pi);
+	} else {
+		/* unlocked in bgp_zebra_announce_process */
+		bgp_table_lock(bgp_dest_table(dest));
+		bgp_dest_lock_node(dest);
+		zebra_announce_add_tail(&bm->zebra_announce_head, dest);
+	}
+
+	dest->za_bgp_pi = bgp_path_info_lock(info);
+	SET_FLAG(dest->flags, install ? BGP_NODE_SCHEDULE_FOR_INSTALL
+				      : BGP_NODE_SCHEDULE_FOR_DELETE);
+
+	if (!bm->t_zebra_announce)
+		event_add_event(bm->master, bgp_zebra_announce_process, NULL,
+				0, &bm->t_zebra_announce);
+}
+
+/* Forget queued zebra updates of an instance that is going away */
+void bgp_zebra_route_install_purge(struct bgp *bgp)
+{
+	struct bgp_dest *dest;
+
+	frr_each_safe (zebra_announce, &bm->zebra_announce_head, dest) {
+		if (bgp_dest_table(dest)->bgp == bgp)
+			bgp_zebra_route_unschedule(dest);
+	}
+
+	if (!zebra_announce_count(&bm->zebra_announce_head))
+		EVENT_OFF(bm->t_zebra_announce);
+}
+
 /* Withdraw all entries in a BGP instances RIB table from Zebra */
 void bgp_zebra_withdraw_table_all_subtypes(struct bgp *bgp, afi_t afi, safi_t safi)
 {
@@ -3676,6 +3676,7 @@ int bgp_get(struct bgp **bgp_val, as_t *as, const char *name,
 	 */
 	bgp_handle_socket(bgp, vrf, VRF_UNKNOWN, true);
 	listnode_add(bm->bgp, bgp);
+	vpn_leak_rt_import_invalidate();
 
 	if (IS_BGP_INST_KNOWN_TO_ZEBRA(bgp)) {
 		if (BGP_DEBUG(zebra, ZEBRA))
@@ -3811,9 +3812,6 @@ int bgp_delete(struct bgp *bgp)
 
 	hook_call(bgp_inst_delete, bgp);
 
-	FOREACH_AFI_SAFI (afi, safi)
-		EVENT_OFF(bgp->t_revalidate[afi][safi]);
-
 	EVENT_OFF(bgp->t_condition_check);
 	EVENT_OFF(bgp->t_startup);
 	EVENT_OFF(bgp->t_maxmed_onstartup);
@@ -3942,6 +3940,8 @@ int bgp_delete(struct bgp *bgp)
 		}
 	}
 
+	bgp_zebra_route_install_purge(bgp);
+
 	/* Deregister from Zebra, if needed */
 	if (IS_BGP_INST_KNOWN_TO_ZEBRA(bgp)) {
 		if (BGP_DEBUG(zebra, ZEBRA))
@@ -3955,6 +3955,7 @@ int bgp_delete(struct bgp *bgp)
 	 * routes to be processed still referencing the struct bgp.
 	 */
 	listnode_delete(bm->bgp, bgp);
+	vpn_leak_rt_import_invalidate();
 
 	/* Free interfaces in this instance. */
 	bgp_if_finish(bgp);
@@ -8052,6 +8053,8 @@ static void peer_reset_message_stats(struct peer *peer)
 				      memory_order_relaxed);
 		atomic_store_explicit(&peer->dynamic_cap_out, 0,
 				      memory_order_relaxed);
+		atomic_store_explicit(&peer->write_calls, 0,
+				      memory_order_relaxed);
 	}
 }
 
@@ -8252,6 +8255,7 @@ void bgp_master_init(struct event_loop *master, const int buffer_size,
 	bm->outq_limit = BM_DEFAULT_Q_LIMIT;
 	bm->t_bgp_sync_label_manager = NULL;
 	bm->t_bgp_start_label_manager = NULL;
+	zebra_announce_init(&bm->zebra_announce_head);
 
 	bgp_mac_init();
 	/* init the rd id space.
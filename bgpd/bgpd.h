@@ -172,6 +172,12 @@ struct bgp_master {
 
 	bool v6_with_v4_nexthops;
 
+	/* Dests whose selected path still has to be sent to zebra, see
+	 * bgp_zebra_route_install()
+	 */
+	struct zebra_announce_head zebra_announce_head;
+	struct event *t_zebra_announce;
+
 	QOBJ_FIELDS;
 };
 DECLARE_QOBJ_TYPE(bgp_master);
@@ -204,6 +210,8 @@ struct vpn_policy {
 	afi_t afi;
 	struct ecommunity *rtlist[BGP_VPN_POLICY_DIR_MAX];
 	struct ecommunity *import_redirect_rtlist;
+	/* last route-target import index walk this policy was visited in */
+	uint32_t rt_import_walk;
 	char *rmap_name[BGP_VPN_POLICY_DIR_MAX];
 	struct route_map *rmap[BGP_VPN_POLICY_DIR_MAX];
 
@@ -444,7 +452,6 @@ struct bgp {
 	/* BGP update delay on startup */
 	struct event *t_update_delay;
 	struct event *t_establish_wait;
-	struct event *t_revalidate[AFI_MAX][SAFI_MAX];
 
 	uint8_t update_delay_over;
 	uint8_t main_zebra_update_hold;
@@ -1631,6 +1638,7 @@ struct peer {
 	_Atomic uint32_t refresh_out;     /* Route Refresh output count */
 	_Atomic uint32_t dynamic_cap_in;  /* Dynamic Capability input count.  */
 	_Atomic uint32_t dynamic_cap_out; /* Dynamic Capability output count. */
+	_Atomic uint32_t write_calls;     /* Socket writes for sent messages */
 
 	uint32_t stat_pfx_filter;
 	uint32_t stat_pfx_aspath_loop;
@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * as-set aggregate attribute tests: the as-path and communities kept up to
+ * date contributor by contributor must match what
+ * bgp_compute_aggregate_*_val() recomputes from the contributor hashes.
+ */
+
+#include <zebra.h>
+
+#include "vty.h"
+#include "stream.h"
+#include "privs.h"
+#include "queue.h"
+#include "filter.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_community.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_lcommunity.h"
+
+#define VT100_RESET "\x1b[0m"
+#define VT100_RED "\x1b[31m"
+#define VT100_GREEN "\x1b[32m"
+#define OK VT100_GREEN "OK" VT100_RESET
+#define FAILED VT100_RED "failed" VT100_RESET
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+static int failed = 0;
+
+/* Attributes of the contributing routes, referred to as 'A' to 'F' */
+static struct contributor {
+	const char *aspath;
+	const char *comm;
+	const char *ecomm;
+	const char *lcomm;
+} contributors[] = {
+	{ "65001 65002 65010", "65000:1 65000:2", "rt 65000:100", "65000:1:1" },
+	{ "65001 65002 65020", "65000:2 65000:3", "rt 65000:200", "65000:1:2" },
+	{ "65001 65030", "65000:9", "rt 65000:100 rt 65000:300", "65000:2:1" },
+	{ "65001 65002", NULL, NULL, NULL },
+	{ "", "65000:1", NULL, "65000:1:1" },
+	{ "65040 65002 65010", "65000:3", "rt 65000:200", "65000:3:3" },
+};
+
+/* Contributors added ("+A") and removed ("-A") one after the other */
+static struct test_segment {
+	const char *name;
+	const char *desc;
+	const char *steps;
+} test_segments[] = {
+	{
+		"add-new",
+		"every contributor brings new attributes",
+		"+A +B +C +F",
+	},
+	{
+		"add-repeat",
+		"contributors repeating attributes already in the aggregate",
+		"+A +A +B +A +B",
+	},
+	{
+		"add-prefix",
+		"as-paths that are a prefix of one another",
+		"+D +A +B +D +C",
+	},
+	{
+		"add-empty",
+		"locally originated contributor with an empty as-path",
+		"+E +A +E +F",
+	},
+	{
+		"remove-last",
+		"removing the last contributor of an attribute",
+		"+A +B +C -B -A +F -C",
+	},
+	{
+		"remove-repeat",
+		"removing one of several contributors of an attribute",
+		"+A +A +B -A +C -A -B -C",
+	},
+	{
+		"readd",
+		"removing then adding back contributors",
+		"+A +B -A +A +D -B +B +E -E",
+	},
+	{
+		"remove-all",
+		"removing every contributor",
+		"+F +C +D +E -C -F -E -D",
+	},
+	{ NULL, NULL, NULL },
+};
+
+static void aggregate_step(struct bgp_aggregate *aggregate, char op,
+			   const struct contributor *c)
+{
+	struct aspath *aspath;
+	struct community *comm = NULL;
+	struct ecommunity *ecomm = NULL;
+	struct lcommunity *lcomm = NULL;
+
+	aspath = aspath_str2aspath(c->aspath, ASNOTATION_PLAIN);
+	if (c->comm)
+		comm = community_str2com(c->comm);
+	if (c->ecomm)
+		ecomm = ecommunity_str2com(c->ecomm, 0, 1);
+	if (c->lcomm)
+		lcomm = lcommunity_str2com(c->lcomm);
+
+	if (op == '+') {
+		bgp_compute_aggregate_aspath(aggregate, aspath);
+		bgp_compute_aggregate_community(aggregate, comm);
+		bgp_compute_aggregate_ecommunity(aggregate, ecomm);
+		bgp_compute_aggregate_lcommunity(aggregate, lcomm);
+	} else {
+		bgp_remove_aspath_from_aggregate(aggregate, aspath);
+		bgp_remove_community_from_aggregate(aggregate, comm);
+		bgp_remove_ecommunity_from_aggregate(aggregate, ecomm);
+		bgp_remove_lcommunity_from_aggregate(aggregate, lcomm);
+	}
+
+	aspath_free(aspath);
+	if (comm)
+		community_free(&comm);
+	if (ecomm)
+		ecommunity_free(&ecomm);
+	if (lcomm)
+		lcommunity_free(&lcomm);
+}
+
+/*
+ * Each check recomputes the value from the hash, compares it with the one
+ * the steps left, and puts the latter back for the next step.
+ */
+static bool aspath_check(struct bgp_aggregate *aggregate)
+{
+	struct aspath *aspath = aggregate->aspath;
+	bool same;
+
+	aggregate->aspath = NULL;
+	bgp_compute_aggregate_aspath_val(aggregate);
+
+	if (aspath && aggregate->aspath)
+		same = aspath_cmp(aspath, aggregate->aspath);
+	else
+		same = (aspath == aggregate->aspath);
+
+	if (!same)
+		printf("as-path %s, recomputed %s\n",
+		       aspath ? aspath->str : "(none)",
+		       aggregate->aspath ? aggregate->aspath->str : "(none)");
+
+	if (aggregate->aspath)
+		aspath_free(aggregate->aspath);
+	aggregate->aspath = aspath;
+
+	return same;
+}
+
+static bool community_check(struct bgp_aggregate *aggregate)
+{
+	struct community *comm = aggregate->community;
+	bool same;
+
+	aggregate->community = NULL;
+	bgp_compute_aggregate_community_val(aggregate);
+
+	if (comm && aggregate->community)
+		same = community_cmp(comm, aggregate->community);
+	else
+		same = (comm == aggregate->community);
+
+	if (!same)
+		printf("community differs from recomputed\n");
+
+	if (aggregate->community)
+		community_free(&aggregate->community);
+	aggregate->community = comm;
+
+	return same;
+}
+
+static bool ecommunity_check(struct bgp_aggregate *aggregate)
+{
+	struct ecommunity *ecomm = aggregate->ecommunity;
+	bool same;
+
+	aggregate->ecommunity = NULL;
+	bgp_compute_aggregate_ecommunity_val(aggregate);
+
+	if (ecomm && aggregate->ecommunity)
+		same = ecommunity_cmp(ecomm, aggregate->ecommunity);
+	else
+		same = (ecomm == aggregate->ecommunity);
+
+	if (!same)
+		printf("extended community differs from recomputed\n");
+
+	if (aggregate->ecommunity)
+		ecommunity_free(&aggregate->ecommunity);
+	aggregate->ecommunity = ecomm;
+
+	return same;
+}
+
+static bool lcommunity_check(struct bgp_aggregate *aggregate)
+{
+	struct lcommunity *lcomm = aggregate->lcommunity;
+	bool same;
+
+	aggregate->lcommunity = NULL;
+	bgp_compute_aggregate_lcommunity_val(aggregate);
+
+	if (lcomm && aggregate->lcommunity)
+		same = lcommunity_cmp(lcomm, aggregate->lcommunity);
+	else
+		same = (lcomm == aggregate->lcommunity);
+
+	if (!same)
+		printf("large community differs from recomputed\n");
+
+	if (aggregate->lcommunity)
+		lcommunity_free(&aggregate->lcommunity);
+	aggregate->lcommunity = lcomm;
+
+	return same;
+}
+
+static void aggregate_free(struct bgp_aggregate *aggregate)
+{
+	if (aggregate->aspath)
+		aspath_free(aggregate->aspath);
+	if (aggregate->community)
+		community_free(&aggregate->community);
+	if (aggregate->ecommunity)
+		ecommunity_free(&aggregate->ecommunity);
+	if (aggregate->lcommunity)
+		lcommunity_free(&aggregate->lcommunity);
+
+	hash_clean_and_free(&aggregate->aspath_hash, bgp_aggr_aspath_remove);
+	hash_clean_and_free(&aggregate->community_hash,
+			    bgp_aggr_community_remove);
+	hash_clean_and_free(&aggregate->ecommunity_hash,
+			    bgp_aggr_ecommunity_remove);
+	hash_clean_and_free(&aggregate->lcommunity_hash,
+			    bgp_aggr_lcommunity_remove);
+}
+
+static void aggregate_test(const struct test_segment *t)
+{
+	struct bgp_aggregate aggregate = {};
+	const char *step;
+	bool same = true;
+
+	printf("%s: %s\n", t->name, t->desc);
+
+	for (step = t->steps; *step; step++) {
+		if (*step != '+' && *step != '-')
+			continue;
+
+		aggregate_step(&aggregate, step[0],
+			       &contributors[step[1] - 'A']);
+
+		if (!aspath_check(&aggregate) ||
+		    !community_check(&aggregate) ||
+		    !ecommunity_check(&aggregate) ||
+		    !lcommunity_check(&aggregate)) {
+			printf("after %.2s\n", step);
+			same = false;
+			break;
+		}
+	}
+
+	if (same)
+		printf("%s\n\n", OK);
+	else {
+		failed++;
+		printf("%s\n\n", FAILED);
+	}
+
+	aggregate_free(&aggregate);
+}
+
+int main(void)
+{
+	int i = 0;
+
+	while (test_segments[i].name)
+		aggregate_test(&test_segments[i++]);
+
+	printf("failures: %d\n", failed);
+	return failed;
+}
@@ -0,0 +1,15 @@
+import frrtest
+
+
+class TestAggregate(frrtest.TestMultiOut):
+    program = "./test_aggregate"
+
+
+TestAggregate.okfail("add-new")
+TestAggregate.okfail("add-repeat")
+TestAggregate.okfail("add-prefix")
+TestAggregate.okfail("add-empty")
+TestAggregate.okfail("remove-last")
+TestAggregate.okfail("remove-repeat")
+TestAggregate.okfail("readd")
+TestAggregate.okfail("remove-all")
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * bgp_attr_same() tests: the adj-rib-out duplicate check compares the
+ * attribute coming out of outbound policy, whose AS path and communities
+ * are fresh copies, against the interned attribute last advertised.
+ */
+
+#include <zebra.h>
+
+#include "vty.h"
+#include "stream.h"
+#include "privs.h"
+#include "queue.h"
+#include "filter.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_community.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_lcommunity.h"
+
+#define VT100_RESET "\x1b[0m"
+#define VT100_RED "\x1b[31m"
+#define VT100_GREEN "\x1b[32m"
+#define OK VT100_GREEN "OK" VT100_RESET
+#define FAILED VT100_RED "failed" VT100_RESET
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct event_loop *master = NULL;
+
+static int failed = 0;
+
+/* Attribute as the outbound route-map produces it for each test */
+static struct test_segment {
+	const char *name;
+	const char *desc;
+	const char *aspath;	/* before the route-map's prepend */
+	int prepend;		/* "set as-path prepend 65000" count */
+	const char *comm;	/* "set community" */
+	const char *lcomm;	/* "set large-community" */
+	bool atomic;		/* "set atomic-aggregate" */
+	bool med;		/* "set metric 0" */
+	bool same;		/* expected bgp_attr_same() result */
+} test_segments[] = {
+	{
+		"prepend-same",
+		"prepend and community set, same result as advertised",
+		"65001 65002",
+		1,
+		"65000:1 65000:2",
+		"65000:1:1",
+		false,
+		false,
+		true,
+	},
+	{
+		"prepend-twice",
+		"prepend count changed",
+		"65001 65002",
+		2,
+		"65000:1 65000:2",
+		"65000:1:1",
+		false,
+		false,
+		false,
+	},
+	{
+		"aspath-changed",
+		"upstream AS path changed under the same prepend",
+		"65001 65003",
+		1,
+		"65000:1 65000:2",
+		"65000:1:1",
+		false,
+		false,
+		false,
+	},
+	{
+		"community-deleted",
+		"one community removed",
+		"65001 65002",
+		1,
+		"65000:1",
+		"65000:1:1",
+		false,
+		false,
+		false,
+	},
+	{
+		"lcommunity-changed",
+		"large community changed",
+		"65001 65002",
+		1,
+		"65000:1 65000:2",
+		"65000:1:2",
+		false,
+		false,
+		false,
+	},
+	{
+		"atomic-aggregate",
+		"only the atomic-aggregate flag is added",
+		"65001 65002",
+		1,
+		"65000:1 65000:2",
+		"65000:1:1",
+		true,
+		false,
+		false,
+	},
+	{
+		"metric-zero",
+		"MED 0 set on a route without MED",
+		"65001 65002",
+		1,
+		"65000:1 65000:2",
+		"65000:1:1",
+		false,
+		true,
+		false,
+	},
+	{ NULL, NULL, NULL, 0, NULL, NULL, false, false, false },
+};
+
+/* Build the attribute a route-map would hand to the adj-rib-out */
+static void policy_attr(struct attr *attr, const struct test_segment *t)
+{
+	memset(attr, 0, sizeof(*attr));
+	attr->flag = ATTR_FLAG_BIT(BGP_ATTR_ORIGIN) |
+		     ATTR_FLAG_BIT(BGP_ATTR_AS_PATH) |
+		     ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP);
+	attr->origin = BGP_ORIGIN_IGP;
+	attr->nexthop.s_addr = htonl(0x0a000001);
+
+	attr->aspath = aspath_str2aspath(t->aspath, ASNOTATION_PLAIN);
+	if (t->prepend)
+		attr->aspath = aspath_add_seq_n(attr->aspath, 65000,
+						t->prepend);
+
+	bgp_attr_set_community(attr, community_str2com(t->comm));
+	bgp_attr_set_lcommunity(attr, lcommunity_str2com(t->lcomm));
+	bgp_attr_set_ecommunity(attr, ecommunity_str2com("rt 65000:100", 0,
+							  1));
+
+	if (t->atomic)
+		SET_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_ATOMIC_AGGREGATE));
+	if (t->med) {
+		attr->med = 0;
+		SET_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC));
+	}
+}
+
+static void same_test(const struct attr *iattr, const struct test_segment *t)
+{
+	struct attr attr;
+	bool same;
+
+	printf("%s: %s\n", t->name, t->desc);
+
+	policy_attr(&attr, t);
+	same = bgp_attr_same(iattr, &attr);
+
+	if (same == t->same)
+		printf("%s\n\n", OK);
+	else {
+		failed++;
+		printf("expected %s, got %s\n%s\n\n",
+		       t->same ? "same" : "different",
+		       same ? "same" : "different", FAILED);
+	}
+
+	bgp_attr_flush(&attr);
+}
+
+int main(void)
+{
+	struct attr attr, *iattr;
+	int i = 0;
+
+	bgp_attr_init();
+
+	/* What the adj-rib-out last advertised */
+	policy_attr(&attr, &test_segments[0]);
+	iattr = bgp_attr_intern(&attr);
+
+	while (test_segments[i].name)
+		same_test(iattr, &test_segments[i++]);
+
+	bgp_attr_unintern(&iattr);
+
+	printf("failures: %d\n", failed);
+	return failed;
+}
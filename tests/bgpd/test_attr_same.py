@@ -0,0 +1,14 @@
+import frrtest
+
+
+class TestAttrSame(frrtest.TestMultiOut):
+    program = "./test_attr_same"
+
+
+TestAttrSame.okfail("prepend-same")
+TestAttrSame.okfail("prepend-twice")
+TestAttrSame.okfail("aspath-changed")
+TestAttrSame.okfail("community-deleted")
+TestAttrSame.okfail("lcommunity-changed")
+TestAttrSame.okfail("atomic-aggregate")
+TestAttrSame.okfail("metric-zero")
@@ -918,6 +918,15 @@ static int netlink_recv_msg(struct nlsock *nl, struct msghdr *msg)
 
 		bytes = recv(nl->sock, NULL, 0, MSG_PEEK | MSG_TRUNC);
 
+		/*
+		 * Nothing queued on a non-blocking socket: the recvmsg()
+		 * below would only fail the same way. This is the usual end
+		 * of reading a batch's responses, where only errors are
+		 * sent back.
+		 */
+		if (bytes == -1 && (errno == EWOULDBLOCK || errno == EAGAIN))
+			return 0;
+
 		if (bytes >= 0 && (size_t)bytes > nl->buflen) {
 			nl->buf = XREALLOC(MTYPE_NL_BUF, nl->buf, bytes);
 			nl->buflen = bytes;
@@ -305,6 +305,12 @@ struct rib_table_info {
 	afi_t afi;
 	safi_t safi;
 	uint32_t table_id;
+
+	/*
+	 * Number of kernel route entries in the table, lets
+	 * RIB_UPDATE_KERNEL skip tables that have none.
+	 */
+	uint32_t kernel_route_count;
 };
 
 enum rib_tables_iter_state {
@@ -817,6 +817,7 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 				    bool rt_delete)
 {
 	rib_dest_t *dest = rib_dest_from_rnode(rn);
+	struct route_node *changed = rn;
 	struct rnh *rnh;
 
 	/*
@@ -883,6 +884,21 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 				continue;
 			}
 
+			/*
+			 * A nexthop resolved further up the tree can only
+			 * be affected by the changed route if it falls
+			 * within it. Otherwise, e.g., a /32 flapping would
+			 * re-evaluate everything resolving over, or parked
+			 * unresolved at, the default route.
+			 */
+			if (rn != changed && !prefix_match(&changed->p, p)) {
+				if (IS_ZEBRA_DEBUG_NHT_DETAILED)
+					zlog_debug(
+						"    Nexthop not covered by %pRN",
+						changed);
+				continue;
+			}
+
 			rnh->seqno = seq;
 			zebra_evaluate_rnh(zvrf, family2afi(p->family), 0, p,
 					   rnh->safi);
@@ -3855,6 +3871,21 @@ rib_dest_t *zebra_rib_create_dest(struct route_node *rn)
 	return dest;
 }
 
+/* Count the kernel routes of the route node's table. */
+static void rib_kernel_route_count_update(struct route_node *rn, bool add)
+{
+	struct rib_table_info *info;
+
+	info = rib_table_info(srcdest_rnode_table(rn));
+	if (!info)
+		return;
+
+	if (add)
+		info->kernel_route_count++;
+	else if (info->kernel_route_count)
+		info->kernel_route_count--;
+}
+
 /* RIB updates are processed via a queue of pointers to route_nodes.
  *
  * The queue length is bounded by the maximal size of the routing table,
@@ -3911,6 +3942,9 @@ static void rib_link(struct route_node *rn, struct route_entry *re, int process)
 
 	re_list_add_head(&dest->routes, re);
 
+	if (re->type == ZEBRA_ROUTE_KERNEL)
+		rib_kernel_route_count_update(rn, true);
+
 	afi = (rn->p.family == AF_INET)
 		      ? AFI_IP
 		      : (rn->p.family == AF_INET6) ? AFI_IP6 : AFI_MAX;
@@ -3965,6 +3999,9 @@ void rib_unlink(struct route_node *rn, struct route_entry *re)
 
 	re_list_del(&dest->routes, re);
 
+	if (re->type == ZEBRA_ROUTE_KERNEL)
+		rib_kernel_route_count_update(rn, false);
+
 	if (dest->selected_fib == re)
 		dest->selected_fib = NULL;
 
@@ -4409,6 +4446,13 @@ void rib_update_table(struct route_table *table, enum rib_update_event event,
 			   rib_update_event2str(event), zebra_route_string(rtype));
 	}
 
+	/* Interface and address deletions trigger a kernel route update
+	 * for every table, don't walk the ones without any kernel routes.
+	 */
+	if (event == RIB_UPDATE_KERNEL && table->info &&
+	    !rib_table_info(table)->kernel_route_count)
+		return;
+
 	/* Walk all routes and queue for processing, if appropriate for
 	 * the trigger event.
 	 */
@@ -293,161 +293,196 @@ zwrite_fail:
  * onto the input queue and then notify the main thread that there is new data
  * available.
  *
- * This function first looks for any data in the client structure's working
- * input buffer. If data is present, it is assumed that reading stopped in a
- * previous invocation of this task and needs to be resumed to finish a message.
- * Otherwise, the socket data stream is assumed to be at the beginning of a new
- * ZAPI message (specifically at the header). The header is read and validated.
- * If the header passed validation then the length field found in the header is
- * used to compute the total length of the message. That much data is read (but
- * not inspected), appended to the header, placed into a stream and pushed onto
- * the client's input queue. A task is then scheduled on the main thread to
- * process the client's input queue. Finally, if all of this was successful,
- * this task reschedules itself.
+ * Each read from the socket fills as much of the client structure's working
+ * input buffer as is available, so that a client pushing many small messages
+ * (e.g., route updates at startup) costs one system call per buffer rather
+ * than two per message. Every complete ZAPI message in the buffer then has
+ * its header validated, is copied into its own stream and pushed onto the
+ * client's input queue. A trailing partial message is moved to the front of
+ * the working buffer to be completed by the next read. At most
+ * zrouter.packets_to_process messages are queued per run; complete messages
+ * beyond that stay in the working buffer for the next run. A task is then
+ * scheduled on the main thread to process the client's input queue. Finally,
+ * if all of this was successful, this task reschedules itself.
  *
  * Any failure in any of these actions is handled by terminating the client.
  */
 static void zserv_read(struct event *thread)
 {
 	struct zserv *client = EVENT_ARG(thread);
+	struct stream *ibuf = client->ibuf_work;
 	int sock;
-	size_t already;
 	struct stream_fifo *cache;
-	uint32_t p2p_orig;
-
 	uint32_t p2p;
+	uint32_t reads = 0, queued = 0;
+	size_t fifo_limit, fifo_count;
+	size_t budget;
+	uint16_t command = 0;
+	bool drained = false;
+	bool paused = false;
+
 	struct zmsghdr hdr;
 
-	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
-					memory_order_relaxed);
+	p2p = atomic_load_explicit(&zrouter.packets_to_process,
+				   memory_order_relaxed);
 	cache = stream_fifo_new();
-	p2p = p2p_orig;
-	sock = EVENT_FD(thread);
+	/* Not EVENT_FD(): we also run as an event, see zserv_client_event() */
+	sock = client->sock;
+
+	/*
+	 * Stop reading once the input queue would hold this many messages,
+	 * so that the main pthread falling behind bounds what we queue.
+	 */
+	fifo_limit = ZSERV_IBUF_FIFO_BATCHES * p2p;
+	frr_with_mutex (&client->ibuf_mtx) {
+		fifo_count = stream_fifo_count_safe(client->ibuf_fifo);
+	}
+	budget = fifo_count < fifo_limit ? fifo_limit - fifo_count : 0;
+	budget = MIN(budget, p2p);
 
-	while (p2p) {
+	for (;;) {
 		ssize_t nb;
+		size_t want;
 		bool hdrvalid;
 		char errmsg[256];
 
-		already = stream_get_endp(client->ibuf_work);
+		/*
+		 * Split off the complete messages in the buffer, up to
+		 * packets-to-process for this run and the room left on the
+		 * input queue.
+		 */
+		while (queued < budget &&
+		       STREAM_READABLE(ibuf) >= ZEBRA_HEADER_SIZE) {
+			size_t getp = stream_get_getp(ibuf);
+			struct stream *msg;
+
+			/* Fetch header values */
+			hdrvalid = zapi_parse_header(ibuf, &hdr);
+			stream_set_getp(ibuf, getp);
+
+			if (!hdrvalid) {
+				snprintf(errmsg, sizeof(errmsg),
+					 "%s: Message has corrupt header",
+					 __func__);
+				zserv_log_message(errmsg, ibuf, NULL);
+				goto zread_fail;
+			}
 
-		/* Read length and command (if we don't have it already). */
-		if (already < ZEBRA_HEADER_SIZE) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     ZEBRA_HEADER_SIZE - already);
-			if ((nb == 0 || nb == -1)) {
-				if (IS_ZEBRA_DEBUG_EVENT)
-					zlog_debug("connection closed socket [%d]",
-						   sock);
+			/* Validate header */
+			if (hdr.marker != ZEBRA_HEADER_MARKER
+			    || hdr.version != ZSERV_VERSION) {
+				snprintf(
+					errmsg, sizeof(errmsg),
+					"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
+					__func__, sock, hdr.marker,
+					hdr.version);
+				zserv_log_message(errmsg, ibuf, &hdr);
 				goto zread_fail;
 			}
-			if (nb != (ssize_t)(ZEBRA_HEADER_SIZE - already)) {
-				/* Try again later. */
-				break;
+			if (hdr.length < ZEBRA_HEADER_SIZE) {
+				snprintf(
+					errmsg, sizeof(errmsg),
+					"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
+					__func__, sock, hdr.length,
+					ZEBRA_HEADER_SIZE);
+				zserv_log_message(errmsg, ibuf, &hdr);
+				goto zread_fail;
+			}
+			if (hdr.length > STREAM_SIZE(ibuf)) {
+				snprintf(
+					errmsg, sizeof(errmsg),
+					"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
+					__func__, sock, hdr.length,
+					(unsigned long)STREAM_SIZE(ibuf));
+				zserv_log_message(errmsg, ibuf, &hdr);
+				goto zread_fail;
 			}
-			already = ZEBRA_HEADER_SIZE;
-		}
-
-		/* Reset to read from the beginning of the incoming packet. */
-		stream_set_getp(client->ibuf_work, 0);
 
-		/* Fetch header values */
-		hdrvalid = zapi_parse_header(client->ibuf_work, &hdr);
+			/* Rest of the message not in yet */
+			if (STREAM_READABLE(ibuf) < hdr.length)
+				break;
 
-		if (!hdrvalid) {
-			snprintf(errmsg, sizeof(errmsg),
-				 "%s: Message has corrupt header", __func__);
-			zserv_log_message(errmsg, client->ibuf_work, NULL);
-			goto zread_fail;
-		}
+			/* Debug packet information. */
+			if (IS_ZEBRA_DEBUG_PACKET)
+				zlog_debug("zebra message[%s:%u:%u] comes from socket [%d]",
+					   zserv_command_string(hdr.command),
+					   hdr.vrf_id, hdr.length, sock);
 
-		/* Validate header */
-		if (hdr.marker != ZEBRA_HEADER_MARKER
-		    || hdr.version != ZSERV_VERSION) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
-				__func__, sock, hdr.marker, hdr.version);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
-		if (hdr.length < ZEBRA_HEADER_SIZE) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
-				__func__, sock, hdr.length, ZEBRA_HEADER_SIZE);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
-		if (hdr.length > STREAM_SIZE(client->ibuf_work)) {
-			snprintf(
-				errmsg, sizeof(errmsg),
-				"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
-				__func__, sock, hdr.length,
-				(unsigned long)STREAM_SIZE(client->ibuf_work));
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
-			goto zread_fail;
-		}
+			msg = stream_new(hdr.length);
+			stream_get(STREAM_DATA(msg), ibuf, hdr.length);
+			stream_set_endp(msg, hdr.length);
 
-		/* Read rest of data. */
-		if (already < hdr.length) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     hdr.length - already);
-			if ((nb == 0 || nb == -1)) {
-				if (IS_ZEBRA_DEBUG_EVENT)
-					zlog_debug(
-						   "connection closed [%d] when reading zebra data",
-						   sock);
-				goto zread_fail;
-			}
-			if (nb != (ssize_t)(hdr.length - already)) {
-				/* Try again later. */
-				break;
-			}
+			stream_fifo_push(cache, msg);
+			command = hdr.command;
+			queued++;
 		}
 
-		/* Debug packet information. */
-		if (IS_ZEBRA_DEBUG_PACKET)
-			zlog_debug("zebra message[%s:%u:%u] comes from socket [%d]",
-				   zserv_command_string(hdr.command),
-				   hdr.vrf_id, hdr.length,
-				   sock);
+		if (queued >= budget || drained)
+			break;
 
-		stream_set_getp(client->ibuf_work, 0);
-		struct stream *msg = stream_dup(client->ibuf_work);
+		/* Keep any partial message at the start of the buffer. */
+		stream_pulldown(ibuf);
+
+		/* Read whatever the socket has, up to the buffer's space. */
+		want = STREAM_WRITEABLE(ibuf);
+		nb = stream_read_try(ibuf, sock, want);
+		reads++;
+		if (nb == 0 || nb == -1) {
+			if (IS_ZEBRA_DEBUG_EVENT)
+				zlog_debug("connection closed socket [%d]",
+					   sock);
+			goto zread_fail;
+		}
 
-		stream_fifo_push(cache, msg);
-		stream_reset(client->ibuf_work);
-		p2p--;
+		/* Socket drained, try again once it is readable. */
+		if (nb < 0 || (size_t)nb < want)
+			drained = true;
 	}
 
-	if (p2p < p2p_orig) {
+	if (cache->head) {
 		uint64_t time_now = monotime(NULL);
 
 		/* update session statistics */
 		frr_with_mutex (&client->stats_mtx) {
 			client->last_read_time = time_now;
-			client->last_read_cmd = hdr.command;
+			client->last_read_cmd = command;
 		}
+	}
 
-		/* publish read packets on client's input queue */
-		frr_with_mutex (&client->ibuf_mtx) {
-			while (cache->head)
-				stream_fifo_push(client->ibuf_fifo,
-						 stream_fifo_pop(cache));
+	/* publish read packets on client's input queue */
+	frr_with_mutex (&client->ibuf_mtx) {
+		while (cache->head)
+			stream_fifo_push(client->ibuf_fifo,
+					 stream_fifo_pop(cache));
+
+		fifo_count = stream_fifo_count_safe(client->ibuf_fifo);
+		if (fifo_count > client->ibuf_fifo_max)
+			client->ibuf_fifo_max = fifo_count;
+
+		/*
+		 * Stop reading while the main pthread is this far behind;
+		 * the socket buffer then pushes back on the client rather
+		 * than zebra queueing without bound.
+		 * zserv_process_messages() resumes reading.
+		 */
+		if (fifo_count >= fifo_limit) {
+			client->ibuf_paused = true;
+			client->ibuf_pause_cnt++;
+			paused = true;
 		}
+	}
 
-		/* Schedule job to process those packets */
+	/* Schedule job to process those packets */
+	if (queued)
 		zserv_event(client, ZSERV_PROCESS_MESSAGES);
 
-	}
-
 	if (IS_ZEBRA_DEBUG_PACKET)
-		zlog_debug("Read %d packets from client: %s", p2p_orig - p2p,
-			   zebra_route_string(client->proto));
+		zlog_debug("Read %u packets in %u reads from client: %s",
+			   queued, reads, zebra_route_string(client->proto));
 
 	/* Reschedule ourselves */
-	zserv_client_event(client, ZSERV_CLIENT_READ);
+	if (!paused)
+		zserv_client_event(client, ZSERV_CLIENT_READ);
 
 	stream_fifo_free(cache);
 
@@ -458,13 +493,37 @@ zread_fail:
 	zserv_client_fail(client);
 }
 
+/*
+ * Whether the client's working input buffer already holds a complete
+ * message, left there by a zserv_read() run that reached its limit.
+ */
+static bool zserv_ibuf_work_has_msg(struct zserv *client)
+{
+	struct stream *ibuf = client->ibuf_work;
+	uint16_t length;
+
+	if (STREAM_READABLE(ibuf) < ZEBRA_HEADER_SIZE)
+		return false;
+
+	length = stream_getw_from(ibuf, stream_get_getp(ibuf));
+	return STREAM_READABLE(ibuf) >= length;
+}
+
 static void zserv_client_event(struct zserv *client,
 			       enum zserv_client_event event)
 {
 	switch (event) {
 	case ZSERV_CLIENT_READ:
-		event_add_read(client->pthread->master, zserv_read, client,
-			       client->sock, &client->t_read);
+		/*
+		 * Buffered messages are processed without waiting for the
+		 * socket, which may well have nothing more to say.
+		 */
+		if (zserv_ibuf_work_has_msg(client))
+			event_add_event(client->pthread->master, zserv_read,
+					client, 0, &client->t_read);
+		else
+			event_add_read(client->pthread->master, zserv_read,
+				       client, client->sock, &client->t_read);
 		break;
 	case ZSERV_CLIENT_WRITE:
 		event_add_write(client->pthread->master, zserv_write, client,
@@ -499,6 +558,7 @@ static void zserv_process_messages(struct event *thread)
 	struct stream_fifo *cache = stream_fifo_new();
 	uint32_t p2p = zrouter.packets_to_process;
 	bool need_resched = false;
+	bool resume_read = false;
 
 	frr_with_mutex (&client->ibuf_mtx) {
 		uint32_t i;
@@ -513,8 +573,21 @@ static void zserv_process_messages(struct event *thread)
 		 */
 		if (stream_fifo_head(client->ibuf_fifo))
 			need_resched = true;
+
+		/* Let the client pthread read again once we have caught
+		 * up to half the limit.
+		 */
+		if (client->ibuf_paused &&
+		    stream_fifo_count_safe(client->ibuf_fifo) <
+			    ZSERV_IBUF_FIFO_BATCHES * p2p / 2) {
+			client->ibuf_paused = false;
+			resume_read = true;
+		}
 	}
 
+	if (resume_read)
+		zserv_client_event(client, ZSERV_CLIENT_READ);
+
 	/* Process the batch of messages */
 	if (stream_fifo_head(cache))
 		zserv_handle_commands(client, cache);
@@ -526,10 +599,20 @@ static void zserv_process_messages(struct event *thread)
 		zserv_event(client, ZSERV_PROCESS_MESSAGES);
 }
 
+/* Must be called with obuf_mtx held */
+static void zserv_obuf_fifo_max_update(struct zserv *client)
+{
+	size_t count = stream_fifo_count_safe(client->obuf_fifo);
+
+	if (count > client->obuf_fifo_max)
+		client->obuf_fifo_max = count;
+}
+
 int zserv_send_message(struct zserv *client, struct stream *msg)
 {
 	frr_with_mutex (&client->obuf_mtx) {
 		stream_fifo_push(client->obuf_fifo, msg);
+		zserv_obuf_fifo_max_update(client);
 	}
 
 	zserv_client_event(client, ZSERV_CLIENT_WRITE);
@@ -550,6 +633,7 @@ int zserv_send_batch(struct zserv *client, struct stream_fifo *fifo)
 			stream_fifo_push(client->obuf_fifo, msg);
 			msg = stream_fifo_pop(fifo);
 		}
+		zserv_obuf_fifo_max_update(client);
 	}
 
 	zserv_client_event(client, ZSERV_CLIENT_WRITE);
@@ -1091,11 +1175,17 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 		client->local_es_evi_add_cnt, 0, client->local_es_evi_del_cnt);
 	vty_out(vty, "Errors: %u\n", client->error_cnt);
 
-#if defined DEV_BUILD
-	vty_out(vty, "Input Fifo: %zu:%zu Output Fifo: %zu:%zu\n",
-		client->ibuf_fifo->count, client->ibuf_fifo->max_count,
-		client->obuf_fifo->count, client->obuf_fifo->max_count);
-#endif
+	frr_with_mutex (&client->ibuf_mtx) {
+		vty_out(vty, "Input Fifo: %zu:%zu Read Pauses: %u%s\n",
+			stream_fifo_count_safe(client->ibuf_fifo),
+			client->ibuf_fifo_max, client->ibuf_pause_cnt,
+			client->ibuf_paused ? " (paused)" : "");
+	}
+	frr_with_mutex (&client->obuf_mtx) {
+		vty_out(vty, "Output Fifo: %zu:%zu\n",
+			stream_fifo_count_safe(client->obuf_fifo),
+			client->obuf_fifo_max);
+	}
 	vty_out(vty, "\n");
 }
 
@@ -46,6 +46,11 @@ struct zebra_vrf;
 /* Count of stale routes processed in timer context */
 #define ZEBRA_MAX_STALE_ROUTE_COUNT 50000
 
+/* Stop reading from a client once this many batches of zapi-packets
+ * messages are waiting for the main pthread.
+ */
+#define ZSERV_IBUF_FIFO_BATCHES 10
+
 /* Graceful Restart information */
 struct client_gr_info {
 	/* VRF for which GR enabled */
@@ -90,8 +95,15 @@ struct zserv {
 	/* Input/output buffer to the client. */
 	pthread_mutex_t ibuf_mtx;
 	struct stream_fifo *ibuf_fifo;
+	/* BEGIN covered by ibuf_mtx */
+	size_t ibuf_fifo_max;	/* high-water mark */
+	bool ibuf_paused;	/* reads held off until fifo drains */
+	uint32_t ibuf_pause_cnt;
+	/* END covered by ibuf_mtx */
 	pthread_mutex_t obuf_mtx;
 	struct stream_fifo *obuf_fifo;
+	/* high-water mark, covered by obuf_mtx */
+	size_t obuf_fifo_max;
 
 	/* Private I/O buffers */
 	struct stream *ibuf_work;